@@ -0,0 +1,198 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring> // for memcpy, memcmp
+#include <limits>
+
+#include "BLEDeviceProfiles.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Device-side advert scheduler
+// Sensor drivers post new values into a per-group staging area whenever
+// they have them; nothing is packed at that point. Once per advertising
+// interval the radio task calls tick(). It picks the next group by
+// rate, re-packs that group with packSensorGroupData() only if values
+// were posted since its last pack, and reports whether the advert bytes
+// differ from the ones the radio already has.
+//
+//   AdvertScheduler scheduler;
+//   scheduler.addGroup(SensorGroup::ENVIRONMENTAL, envProfile, 3);
+//   scheduler.addGroup(SensorGroup::SYSTEM, sysProfile, 1);
+//
+//   // drivers, any thread or interrupt
+//   scheduler.post(SensorGroup::ENVIRONMENTAL, 0, temperature);
+//
+//   // advertising interval timer
+//   AdvertSlot slot = scheduler.tick();
+//   if (slot.changed) setAdvertData(slot.data, slot.size);
+//
+// post() is lock-free and may run concurrently with tick(). Each field
+// value is updated atomically; values from a multi-field post() may
+// land in two consecutive adverts. addGroup() / setRate() and tick()
+// must be called from one thread.
+// -------------------------------------------------------------
+struct AdvertSlot {
+    SensorGroup group;     // UNKNOWN when no group has data yet
+    const uint8_t* data;   // manufacturer data, company ID prefix included
+    size_t size;
+    bool changed;          // differs from the advert returned by the previous tick()
+};
+
+class AdvertScheduler {
+public:
+    AdvertScheduler() : lastGroup_(SensorGroup::UNKNOWN) {}
+
+    AdvertScheduler(const AdvertScheduler&) = delete;
+    AdvertScheduler& operator=(const AdvertScheduler&) = delete;
+
+    // Schedule group with profile's layout. rate is its relative share of
+    // advertising intervals: rate 3 is sent three times as often as rate 1.
+    // The profile must outlive the scheduler. False when the group is
+    // unknown, already added or rate is 0.
+    bool addGroup(SensorGroup group, const DeviceProfile& profile, uint32_t rate = 1) {
+        size_t g = static_cast<size_t>(group);
+        if (g >= KNOWN_GROUP_COUNT || groups_[g].profile || rate == 0) return false;
+
+        Staging& s = groups_[g];
+        s.profile = &profile;
+        s.fieldCount = profile.manufacturerFormat.dataFields.size();
+        s.values.reset(new std::atomic<uint32_t>[s.fieldCount ? s.fieldCount : 1]);
+        const uint32_t missing = floatBits(std::numeric_limits<float>::quiet_NaN());
+        for (size_t i = 0; i < s.fieldCount; ++i) s.values[i].store(missing, std::memory_order_relaxed);
+        s.advert.assign(2 + static_cast<size_t>(profile.manufacturerFormat.totalLength), 0);
+        s.rate = rate;
+
+        if (s.fieldCount > scratchValues_.size()) scratchValues_.resize(s.fieldCount);
+        if (s.advert.size() > scratchAdvert_.size()) scratchAdvert_.resize(s.advert.size());
+        return true;
+    }
+
+    // Change a group's rate; false when the group was not added or rate is 0
+    bool setRate(SensorGroup group, uint32_t rate) {
+        size_t g = static_cast<size_t>(group);
+        if (g >= KNOWN_GROUP_COUNT || !groups_[g].profile || rate == 0) return false;
+        groups_[g].rate = rate;
+        return true;
+    }
+
+    // Stage the value of field index (ordinal in the group's format).
+    // NaN clears the field. False when the group or field does not exist.
+    bool post(SensorGroup group, size_t index, float value) {
+        size_t g = static_cast<size_t>(group);
+        if (g >= KNOWN_GROUP_COUNT || !groups_[g].profile || index >= groups_[g].fieldCount) return false;
+        Staging& s = groups_[g];
+        s.values[index].store(floatBits(value), std::memory_order_relaxed);
+        s.dirty.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // Stage values[0..count) for the group's fields 0..count-1; NaN entries
+    // are skipped and keep their staged value. Returns the values staged.
+    size_t post(SensorGroup group, const float* values, size_t count) {
+        size_t g = static_cast<size_t>(group);
+        if (g >= KNOWN_GROUP_COUNT || !groups_[g].profile) return 0;
+        Staging& s = groups_[g];
+        size_t n = count < s.fieldCount ? count : s.fieldCount;
+        size_t staged = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (values[i] != values[i]) continue;
+            s.values[i].store(floatBits(values[i]), std::memory_order_relaxed);
+            ++staged;
+        }
+        if (staged) s.dirty.store(true, std::memory_order_release);
+        return staged;
+    }
+
+    // Stage the value of the field with the given interned sensor name
+    bool postById(SensorGroup group, SensorNameId id, float value) {
+        size_t g = static_cast<size_t>(group);
+        if (g >= KNOWN_GROUP_COUNT || !groups_[g].profile) return false;
+        const auto& fields = groups_[g].profile->manufacturerFormat.dataFields;
+        for (size_t i = 0; i < fields.size(); ++i)
+            if (fields[i].nameId == id) return post(group, i, value);
+        return false;
+    }
+
+    // Once per advertising interval: the advert to send next. Groups that
+    // never received a value are skipped. Rotation is smooth weighted
+    // round-robin, so a group with rate r gets r of every sum-of-rates
+    // intervals, spread out rather than back to back.
+    AdvertSlot tick() {
+        for (size_t g = 0; g < KNOWN_GROUP_COUNT; ++g) {
+            Staging& s = groups_[g];
+            if (s.profile && !s.posted && s.dirty.load(std::memory_order_acquire)) s.posted = true;
+        }
+
+        Staging* next = nullptr;
+        SensorGroup nextGroup = SensorGroup::UNKNOWN;
+        int64_t total = 0;
+        for (size_t g = 0; g < KNOWN_GROUP_COUNT; ++g) {
+            Staging& s = groups_[g];
+            if (!s.posted) continue;
+            s.credit += s.rate;
+            total += s.rate;
+            if (!next || s.credit > next->credit) {
+                next = &s;
+                nextGroup = static_cast<SensorGroup>(g);
+            }
+        }
+        if (!next) return { SensorGroup::UNKNOWN, nullptr, 0, false };
+        next->credit -= total;
+
+        bool bytesChanged = next->dirty.exchange(false, std::memory_order_acquire) && repack(*next, nextGroup);
+        bool changed = bytesChanged || nextGroup != lastGroup_;
+        lastGroup_ = nextGroup;
+        return { nextGroup, next->advert.data(), next->advert.size(), changed };
+    }
+
+    // Last packed advert of group (zero-filled before its first pack)
+    const uint8_t* advert(SensorGroup group, size_t* size = nullptr) const {
+        size_t g = static_cast<size_t>(group);
+        if (g >= KNOWN_GROUP_COUNT || !groups_[g].profile) return nullptr;
+        if (size) *size = groups_[g].advert.size();
+        return groups_[g].advert.data();
+    }
+
+private:
+    struct Staging {
+        const DeviceProfile* profile = nullptr;
+        size_t fieldCount = 0;
+        std::unique_ptr<std::atomic<uint32_t>[]> values;   // float bits, NaN = no value
+        std::atomic<bool> dirty{false};                    // posted since the last pack
+        bool posted = false;                               // received a value at least once
+        uint32_t rate = 0;
+        int64_t credit = 0;
+        std::vector<uint8_t> advert;
+    };
+
+    static uint32_t floatBits(float v) {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        return bits;
+    }
+
+    // Pack the staged values of s; true when its advert bytes changed
+    bool repack(Staging& s, SensorGroup group) {
+        for (size_t i = 0; i < s.fieldCount; ++i) {
+            uint32_t bits = s.values[i].load(std::memory_order_relaxed);
+            memcpy(&scratchValues_[i], &bits, sizeof(float));
+        }
+        size_t len = packSensorGroupData(scratchValues_.data(), s.fieldCount, group, *s.profile,
+                                         scratchAdvert_.data(), s.advert.size());
+        if (len == 0 || memcmp(scratchAdvert_.data(), s.advert.data(), len) == 0) return false;
+        memcpy(s.advert.data(), scratchAdvert_.data(), len);
+        return true;
+    }
+
+    Staging groups_[KNOWN_GROUP_COUNT];
+    std::vector<float> scratchValues_;
+    std::vector<uint8_t> scratchAdvert_;
+    SensorGroup lastGroup_;
+};
+
+} // namespace BLEProfiles
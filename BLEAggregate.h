@@ -0,0 +1,282 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <limits>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+#include "BLEReadingBatch.h"
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#endif
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Column summaries
+// NaN marks a missing reading and is skipped. An empty summary has
+// count 0, min +inf and max -inf, so merging with it is a no-op; those
+// are merge identities, not statistics: with count 0 there is no min
+// or max and mean() is NaN.
+// -------------------------------------------------------------
+struct ColumnSummary {
+    uint64_t count;
+    float min;
+    float max;
+    double sum;
+
+    ColumnSummary()
+        : count(0), min(std::numeric_limits<float>::infinity()),
+          max(-std::numeric_limits<float>::infinity()), sum(0.0) {}
+
+    double mean() const {
+        return count ? sum / static_cast<double>(count) : std::numeric_limits<double>::quiet_NaN();
+    }
+};
+
+inline void mergeSummary(ColumnSummary& into, const ColumnSummary& from) {
+    into.count += from.count;
+    if (from.min < into.min) into.min = from.min;
+    if (from.max > into.max) into.max = from.max;
+    into.sum += from.sum;
+}
+
+// -------------------------------------------------------------
+// Reduction kernel
+// min/max/count are exact (only the sign of a zero min/max may differ
+// from a sequential loop). Sums are accumulated in double per lane, so
+// they can differ from a sequential sum in the last bits.
+// -------------------------------------------------------------
+inline ColumnSummary summarizeColumn(const float* values, size_t n) {
+    ColumnSummary s;
+    size_t i = 0;
+#if defined(__AVX2__)
+    if (n >= 8) {
+        const __m256 posInf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+        const __m256 negInf = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+        __m256 vmin = posInf, vmax = negInf;
+        __m256d sumLo = _mm256_setzero_pd(), sumHi = _mm256_setzero_pd();
+        uint64_t count = 0;
+        while (i + 8 <= n) {
+            // int32 lane counters are flushed before they can overflow
+            size_t end = (n - i) / 8 > (1u << 20) ? i + 8 * (size_t(1) << 20) : n;
+            __m256i vcount = _mm256_setzero_si256();
+            for (; i + 8 <= end; i += 8) {
+                __m256 v = _mm256_loadu_ps(values + i);
+                __m256 ok = _mm256_cmp_ps(v, v, _CMP_ORD_Q);
+                vmin = _mm256_min_ps(vmin, _mm256_blendv_ps(posInf, v, ok));
+                vmax = _mm256_max_ps(vmax, _mm256_blendv_ps(negInf, v, ok));
+                __m256 z = _mm256_and_ps(v, ok);   // NaN lanes add 0
+                sumLo = _mm256_add_pd(sumLo, _mm256_cvtps_pd(_mm256_castps256_ps128(z)));
+                sumHi = _mm256_add_pd(sumHi, _mm256_cvtps_pd(_mm256_extractf128_ps(z, 1)));
+                vcount = _mm256_sub_epi32(vcount, _mm256_castps_si256(ok));
+            }
+            alignas(32) int32_t c[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(c), vcount);
+            for (int k = 0; k < 8; ++k) count += static_cast<uint32_t>(c[k]);
+        }
+        alignas(32) float mn[8], mx[8];
+        alignas(32) double sl[4], sh[4];
+        _mm256_store_ps(mn, vmin);
+        _mm256_store_ps(mx, vmax);
+        _mm256_store_pd(sl, sumLo);
+        _mm256_store_pd(sh, sumHi);
+        for (int k = 0; k < 8; ++k) {
+            if (mn[k] < s.min) s.min = mn[k];
+            if (mx[k] > s.max) s.max = mx[k];
+        }
+        s.sum = (sl[0] + sl[1]) + (sl[2] + sl[3]) + (sh[0] + sh[1]) + (sh[2] + sh[3]);
+        s.count = count;
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    if (n >= 4) {
+        const __m128 posInf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        const __m128 negInf = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+        __m128 vmin = posInf, vmax = negInf;
+        __m128d sumLo = _mm_setzero_pd(), sumHi = _mm_setzero_pd();
+        uint64_t count = 0;
+        while (i + 4 <= n) {
+            size_t end = (n - i) / 4 > (1u << 20) ? i + 4 * (size_t(1) << 20) : n;
+            __m128i vcount = _mm_setzero_si128();
+            for (; i + 4 <= end; i += 4) {
+                __m128 v = _mm_loadu_ps(values + i);
+                __m128 ok = _mm_cmpord_ps(v, v);
+                vmin = _mm_min_ps(vmin, _mm_or_ps(_mm_and_ps(ok, v), _mm_andnot_ps(ok, posInf)));
+                vmax = _mm_max_ps(vmax, _mm_or_ps(_mm_and_ps(ok, v), _mm_andnot_ps(ok, negInf)));
+                __m128 z = _mm_and_ps(v, ok);
+                sumLo = _mm_add_pd(sumLo, _mm_cvtps_pd(z));
+                sumHi = _mm_add_pd(sumHi, _mm_cvtps_pd(_mm_movehl_ps(z, z)));
+                vcount = _mm_sub_epi32(vcount, _mm_castps_si128(ok));
+            }
+            alignas(16) int32_t c[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(c), vcount);
+            for (int k = 0; k < 4; ++k) count += static_cast<uint32_t>(c[k]);
+        }
+        alignas(16) float mn[4], mx[4];
+        alignas(16) double sl[2], sh[2];
+        _mm_store_ps(mn, vmin);
+        _mm_store_ps(mx, vmax);
+        _mm_store_pd(sl, sumLo);
+        _mm_store_pd(sh, sumHi);
+        for (int k = 0; k < 4; ++k) {
+            if (mn[k] < s.min) s.min = mn[k];
+            if (mx[k] > s.max) s.max = mx[k];
+        }
+        s.sum = (sl[0] + sl[1]) + (sh[0] + sh[1]);
+        s.count = count;
+    }
+#elif defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+    if (n >= 4) {
+        float32x4_t vmin = vdupq_n_f32(std::numeric_limits<float>::infinity());
+        float32x4_t vmax = vdupq_n_f32(-std::numeric_limits<float>::infinity());
+        float64x2_t sumLo = vdupq_n_f64(0.0), sumHi = vdupq_n_f64(0.0);
+        uint64_t count = 0;
+        while (i + 4 <= n) {
+            size_t end = (n - i) / 4 > (1u << 20) ? i + 4 * (size_t(1) << 20) : n;
+            uint32x4_t vcount = vdupq_n_u32(0);
+            for (; i + 4 <= end; i += 4) {
+                float32x4_t v = vld1q_f32(values + i);
+                uint32x4_t ok = vceqq_f32(v, v);
+                vmin = vbslq_f32(ok, vminq_f32(vmin, v), vmin);
+                vmax = vbslq_f32(ok, vmaxq_f32(vmax, v), vmax);
+                float32x4_t z = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), ok));
+                sumLo = vaddq_f64(sumLo, vcvt_f64_f32(vget_low_f32(z)));
+                sumHi = vaddq_f64(sumHi, vcvt_high_f64_f32(z));
+                vcount = vsubq_u32(vcount, ok);
+            }
+            count += vaddvq_u32(vcount);
+        }
+        s.min = vminvq_f32(vmin);
+        s.max = vmaxvq_f32(vmax);
+        s.sum = vaddvq_f64(sumLo) + vaddvq_f64(sumHi);
+        s.count = count;
+    }
+#endif
+    for (; i < n; ++i) {
+        float v = values[i];
+        if (v != v) continue;
+        if (v < s.min) s.min = v;
+        if (v > s.max) s.max = v;
+        s.sum += v;
+        ++s.count;
+    }
+    return s;
+}
+
+// -------------------------------------------------------------
+// Windowed aggregation keyed by SensorGroup
+// Rows are bucketed by timestamp / windowLength; runs of rows that fall
+// in the same window (the common case for time-ordered input) are
+// reduced with summarizeColumn. Within one group, fields are matched by
+// interned name, so formats sharing a group merge field by field.
+//
+//   WindowedAggregator agg(60 * 1000000ull);           // 1 min, timestamps in us
+//   agg.add(SensorGroup::ENVIRONMENTAL, batch);
+//   for (auto& w : agg.flush(nowUs)) ship(w);
+// -------------------------------------------------------------
+struct WindowSummary {
+    SensorGroup group;
+    uint64_t windowStart;                 // first timestamp of the window
+    std::vector<SensorNameId> fieldIds;
+    std::vector<ColumnSummary> fields;    // fields[i] summarizes fieldIds[i]; count 0 if all NaN
+
+    WindowSummary() : group(SensorGroup::UNKNOWN), windowStart(0) {}
+
+    // nullptr when the field has no readings in this window, including a
+    // field whose rows were all NaN (fields[i].count == 0)
+    const ColumnSummary* find(SensorNameId id) const {
+        for (size_t i = 0; i < fieldIds.size(); ++i)
+            if (fieldIds[i] == id) return fields[i].count ? &fields[i] : nullptr;
+        return nullptr;
+    }
+};
+
+class WindowedAggregator {
+public:
+    explicit WindowedAggregator(uint64_t windowLength) : windowLength_(windowLength ? windowLength : 1) {}
+
+    // columns[i] holds count readings of format.fields[i]
+    void add(SensorGroup group, const CompiledFormat& format, const float* const* columns,
+             const uint64_t* timestamps, size_t count) {
+        std::vector<size_t>& slots = slotScratch_;
+        size_t r = 0;
+        while (r < count) {
+            uint64_t window = timestamps[r] / windowLength_;
+            size_t end = r + 1;
+            while (end < count && timestamps[end] / windowLength_ == window) ++end;
+
+            WindowSummary& w = windowFor(group, window);
+            slots.resize(format.fields.size());
+            for (size_t i = 0; i < format.fields.size(); ++i) slots[i] = fieldSlot(w, format.fields[i].nameId);
+            for (size_t i = 0; i < format.fields.size(); ++i)
+                mergeSummary(w.fields[slots[i]], summarizeColumn(columns[i] + r, end - r));
+            r = end;
+        }
+    }
+
+    void add(SensorGroup group, const ReadingBatch& batch) {
+        columnScratch_.resize(batch.columnCount());
+        for (size_t i = 0; i < batch.columnCount(); ++i) columnScratch_[i] = batch.column(i);
+        add(group, batch.format(), columnScratch_.data(), batch.timestamps(), batch.size());
+    }
+
+    // Removes and returns every window that ends at or before timestamp
+    // `before`, ordered by group then window start
+    std::vector<WindowSummary> flush(uint64_t before) {
+        std::vector<WindowSummary> out;
+        for (auto it = windows_.begin(); it != windows_.end();) {
+            if ((it->first.second + 1) * windowLength_ <= before) {
+                out.push_back(std::move(it->second));
+                it = windows_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return out;
+    }
+
+    // Removes and returns every open window
+    std::vector<WindowSummary> flushAll() {
+        std::vector<WindowSummary> out;
+        for (auto& kv : windows_) out.push_back(std::move(kv.second));
+        windows_.clear();
+        return out;
+    }
+
+    size_t openWindows() const { return windows_.size(); }
+    uint64_t windowLength() const { return windowLength_; }
+
+private:
+    WindowSummary& windowFor(SensorGroup group, uint64_t window) {
+        auto key = std::make_pair(group, window);
+        auto it = windows_.find(key);
+        if (it == windows_.end()) {
+            it = windows_.emplace(key, WindowSummary()).first;
+            it->second.group = group;
+            it->second.windowStart = window * windowLength_;
+        }
+        return it->second;
+    }
+
+    static size_t fieldSlot(WindowSummary& w, SensorNameId id) {
+        for (size_t i = 0; i < w.fieldIds.size(); ++i)
+            if (w.fieldIds[i] == id) return i;
+        w.fieldIds.push_back(id);
+        w.fields.emplace_back();
+        return w.fields.size() - 1;
+    }
+
+    uint64_t windowLength_;
+    std::map<std::pair<SensorGroup, uint64_t>, WindowSummary> windows_;
+    std::vector<size_t> slotScratch_;
+    std::vector<const float*> columnScratch_;
+};
+
+} // namespace BLEProfiles
@@ -0,0 +1,152 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#endif
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompanyDispatch.h"
+#include "BLEIngestPipeline.h"
+
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine)
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Coroutine decode channel (C++20)
+// A bounded queue of decoded frames between one producer coroutine and
+// one consumer coroutine on the same executor. The producer awaits
+// push() with a block of raw adverts. Once a slot is free, the block is
+// decoded into that slot with AdvertBatchDecoder. While every slot is
+// full, push() suspends the producer until the consumer releases one
+// (backpressure). The consumer awaits next(). It gets the oldest frame,
+// or nullptr once the channel is closed and drained; the frame stays
+// valid until the following next().
+//
+// The awaiters work with any coroutine type (asio::awaitable, a task
+// type, ...). A suspended side is resumed through the scheduler; the
+// default resumes it inline. With asio, pass a scheduler that posts to
+// the executor so neither side runs nested in the other:
+//
+//   AsyncDecodeChannel ch(table, 4, [ex](std::coroutine_handle<> h) {
+//       asio::post(ex, [h] { h.resume(); });
+//   });
+//   // producer                          // consumer
+//   co_await ch.push(adverts, n);        while (auto* f = co_await ch.next())
+//   ch.close();                              f->forEachBatch(handle);
+//
+// Not thread-safe: both sides must run on one executor (or strand).
+// The dispatch table must outlive the channel.
+// -------------------------------------------------------------
+class AsyncDecodeChannel {
+public:
+    using Scheduler = std::function<void(std::coroutine_handle<>)>;
+
+    AsyncDecodeChannel(const CompanyDispatchTable& table, size_t capacity = 4, Scheduler scheduler = Scheduler())
+        : scheduler_(std::move(scheduler)), head_(0), count_(0), holding_(false), closed_(false)
+    {
+        for (size_t i = 0; i < (capacity ? capacity : 1); ++i)
+            slots_.emplace_back(new AdvertBatchDecoder(table));
+    }
+
+    AsyncDecodeChannel(const AsyncDecodeChannel&) = delete;
+    AsyncDecodeChannel& operator=(const AsyncDecodeChannel&) = delete;
+
+    // co_await push(records, n): true when decoded and queued, false when
+    // the channel was closed first. records must stay valid until then.
+    class PushAwaiter {
+    public:
+        PushAwaiter(AsyncDecodeChannel& ch, const RawAdvert* records, size_t n)
+            : ch_(ch), records_(records), n_(n) {}
+        bool await_ready() const { return ch_.closed_ || ch_.count_ < ch_.slots_.size(); }
+        void await_suspend(std::coroutine_handle<> h) { ch_.producer_ = h; }
+        bool await_resume() { return ch_.enqueue(records_, n_); }
+    private:
+        AsyncDecodeChannel& ch_;
+        const RawAdvert* records_;
+        size_t n_;
+    };
+
+    // co_await next(): the oldest decoded frame, or nullptr when closed and drained
+    class NextAwaiter {
+    public:
+        explicit NextAwaiter(AsyncDecodeChannel& ch) : ch_(ch) {}
+        bool await_ready() {
+            ch_.releaseCurrent();
+            return ch_.count_ > 0 || ch_.closed_;
+        }
+        void await_suspend(std::coroutine_handle<> h) { ch_.consumer_ = h; }
+        const AdvertBatchDecoder* await_resume() { return ch_.takeCurrent(); }
+    private:
+        AsyncDecodeChannel& ch_;
+    };
+
+    PushAwaiter push(const RawAdvert* records, size_t n) { return PushAwaiter(*this, records, n); }
+    NextAwaiter next() { return NextAwaiter(*this); }
+
+    // Non-suspending push; false when the channel is full or closed
+    bool tryPush(const RawAdvert* records, size_t n) {
+        if (closed_ || count_ >= slots_.size()) return false;
+        return enqueue(records, n);
+    }
+
+    // Queued frames are still delivered; later pushes fail
+    void close() {
+        closed_ = true;
+        wake(producer_);
+        wake(consumer_);
+    }
+
+    bool closed() const { return closed_; }
+    size_t size() const { return count_; }   // queued frames, including the one the consumer holds
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    bool enqueue(const RawAdvert* records, size_t n) {
+        if (closed_) return false;
+        slots_[(head_ + count_) % slots_.size()]->decode(records, n);
+        ++count_;
+        wake(consumer_);
+        return true;
+    }
+
+    void releaseCurrent() {
+        if (!holding_) return;
+        holding_ = false;
+        head_ = (head_ + 1) % slots_.size();
+        --count_;
+        wake(producer_);
+    }
+
+    const AdvertBatchDecoder* takeCurrent() {
+        if (count_ == 0) return nullptr;
+        holding_ = true;
+        return slots_[head_].get();
+    }
+
+    void wake(std::coroutine_handle<>& waiter) {
+        if (!waiter) return;
+        std::coroutine_handle<> h = waiter;
+        waiter = nullptr;
+        if (scheduler_) scheduler_(h);
+        else h.resume();
+    }
+
+    std::vector<std::unique_ptr<AdvertBatchDecoder>> slots_;
+    Scheduler scheduler_;
+    size_t head_;
+    size_t count_;
+    bool holding_;   // the consumer holds slots_[head_]
+    bool closed_;
+    std::coroutine_handle<> producer_;
+    std::coroutine_handle<> consumer_;
+};
+
+} // namespace BLEProfiles
+
+#endif // __cpp_impl_coroutine
@@ -0,0 +1,270 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring> // for memcpy
+#include <limits>
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Lane kernels: widen raw integers to float and apply scale.
+// Results are bit-identical to the scalar static_cast<float>(v) * scale.
+// -------------------------------------------------------------
+inline void convertScaleInt32(const int32_t* in, float scale, float* out, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 s8 = _mm256_set1_ps(scale);
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), s8));
+    }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128 s4 = _mm_set1_ps(scale);
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(v), s4));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t v = vld1q_s32(in + i);
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(v), scale));
+    }
+#endif
+    for (; i < n; ++i) out[i] = static_cast<float>(in[i]) * scale;
+}
+
+// Unsigned 32-bit values are split into 16-bit halves: both convert exactly,
+// so hi * 65536 + lo rounds once, like a direct uint32 -> float conversion.
+inline void convertScaleUInt32(const uint32_t* in, float scale, float* out, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 s8 = _mm256_set1_ps(scale);
+    const __m256 k8 = _mm256_set1_ps(65536.0f);
+    const __m256i lo8 = _mm256_set1_epi32(0xFFFF);
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_srli_epi32(v, 16));
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_and_si256(v, lo8));
+        __m256 f  = _mm256_add_ps(_mm256_mul_ps(hi, k8), lo);
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(f, s8));
+    }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128 s4 = _mm_set1_ps(scale);
+    const __m128 k4 = _mm_set1_ps(65536.0f);
+    const __m128i lo4 = _mm_set1_epi32(0xFFFF);
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srli_epi32(v, 16));
+        __m128 lo = _mm_cvtepi32_ps(_mm_and_si128(v, lo4));
+        __m128 f  = _mm_add_ps(_mm_mul_ps(hi, k4), lo);
+        _mm_storeu_ps(out + i, _mm_mul_ps(f, s4));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t v = vld1q_u32(in + i);
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_u32(v), scale));
+    }
+#endif
+    for (; i < n; ++i) out[i] = static_cast<float>(in[i]) * scale;
+}
+
+inline void scaleFloat(float* inOut, float scale, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 s8 = _mm256_set1_ps(scale);
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(inOut + i, _mm256_mul_ps(_mm256_loadu_ps(inOut + i), s8));
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128 s4 = _mm_set1_ps(scale);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(inOut + i, _mm_mul_ps(_mm_loadu_ps(inOut + i), s4));
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(inOut + i, vmulq_n_f32(vld1q_f32(inOut + i), scale));
+#endif
+    for (; i < n; ++i) inOut[i] *= scale;
+}
+
+// -------------------------------------------------------------
+// Column decode of one field across a block of packets
+// rowPtr(r) returns the payload pointer (after the company ID) of row r
+// -------------------------------------------------------------
+inline constexpr size_t BATCH_BLOCK_ROWS = 64;
+
+template <typename RowPtr>
+inline void decodeColumnBlock(const CompiledField& f, RowPtr rowPtr, size_t rows, float* out) {
+    union {
+        int32_t  i32[BATCH_BLOCK_ROWS];
+        uint32_t u32[BATCH_BLOCK_ROWS];
+    } raw;
+
+    switch (f.dataType) {
+    case DataType::UINT8:
+        for (size_t r = 0; r < rows; ++r) raw.i32[r] = rowPtr(r)[f.offset];
+        convertScaleInt32(raw.i32, f.scale, out, rows);
+        break;
+    case DataType::INT8:
+        for (size_t r = 0; r < rows; ++r) raw.i32[r] = static_cast<int8_t>(rowPtr(r)[f.offset]);
+        convertScaleInt32(raw.i32, f.scale, out, rows);
+        break;
+    case DataType::UINT16_LE:
+    case DataType::UINT16_BE: {
+        const bool be = f.dataType == DataType::UINT16_BE;
+        for (size_t r = 0; r < rows; ++r) raw.i32[r] = loadUInt16(rowPtr(r) + f.offset, be);
+        convertScaleInt32(raw.i32, f.scale, out, rows);
+        break;
+    }
+    case DataType::INT16_LE:
+    case DataType::INT16_BE: {
+        const bool be = f.dataType == DataType::INT16_BE;
+        for (size_t r = 0; r < rows; ++r) raw.i32[r] = static_cast<int16_t>(loadUInt16(rowPtr(r) + f.offset, be));
+        convertScaleInt32(raw.i32, f.scale, out, rows);
+        break;
+    }
+    case DataType::UINT32_LE:
+    case DataType::UINT32_BE: {
+        const bool be = f.dataType == DataType::UINT32_BE;
+        for (size_t r = 0; r < rows; ++r) raw.u32[r] = loadUInt32(rowPtr(r) + f.offset, be);
+        convertScaleUInt32(raw.u32, f.scale, out, rows);
+        break;
+    }
+    case DataType::FLOAT_LE:
+    case DataType::FLOAT_BE: {
+        const bool be = f.dataType == DataType::FLOAT_BE;
+        for (size_t r = 0; r < rows; ++r) out[r] = loadFloat(rowPtr(r) + f.offset, be);
+        scaleFloat(out, f.scale, rows);
+        break;
+    }
+    case DataType::UINT_BITS:
+        for (size_t r = 0; r < rows; ++r) raw.u32[r] = loadFieldBits(f, rowPtr(r) + f.offset);
+        convertScaleUInt32(raw.u32, f.scale, out, rows);
+        break;
+    case DataType::INT_BITS:
+        for (size_t r = 0; r < rows; ++r) raw.i32[r] = signedFieldBits(f, loadFieldBits(f, rowPtr(r) + f.offset));
+        convertScaleInt32(raw.i32, f.scale, out, rows);
+        break;
+    default:
+        for (size_t r = 0; r < rows; ++r) out[r] = loadCompiledField(f, rowPtr(r));
+        break;
+    }
+}
+
+// -------------------------------------------------------------
+// Batch decode, column-oriented output
+// columns[i] points at an array of at least count floats for field i.
+// -------------------------------------------------------------
+
+// Strided input: packet r (company ID prefix included) starts at base + r * stride.
+// Every packet must hold at least 2 + format.minPayloadLength bytes, i.e. stride must be large enough.
+// Returns the number of packets decoded (0 if the stride is too small).
+inline size_t decodeBatch(
+    const CompiledFormat& format,
+    const uint8_t* base,
+    size_t stride,
+    size_t count,
+    float* const* columns)
+{
+    BLE_COUNT_CYCLES(PARSE_CALLS, PARSE_CYCLES);
+    if (!base || !columns || stride < 2 + format.minPayloadLength) return 0;
+    BLE_COUNT_PACKETS(format.companyId, count);
+
+    for (size_t row = 0; row < count; row += BATCH_BLOCK_ROWS) {
+        size_t rows = (count - row < BATCH_BLOCK_ROWS) ? count - row : BATCH_BLOCK_ROWS;
+        const uint8_t* blockBase = base + row * stride + 2;
+        auto rowPtr = [blockBase, stride](size_t r) { return blockBase + r * stride; };
+
+        for (size_t i = 0; i < format.fields.size(); ++i)
+            decodeColumnBlock(format.fields[i], rowPtr, rows, columns[i] + row);
+    }
+    return count;
+}
+
+// Scattered input: packets[r] / lengths[r], company ID prefix included.
+// Fields that do not fit in a short packet become NaN, as in CompiledFormat::decode.
+// Returns the number of packets that decoded every field.
+inline size_t decodeBatch(
+    const CompiledFormat& format,
+    const uint8_t* const* packets,
+    const size_t* lengths,
+    size_t count,
+    float* const* columns)
+{
+    BLE_COUNT_CYCLES(PARSE_CALLS, PARSE_CYCLES);
+    if (!packets || !lengths || !columns) return 0;
+    BLE_COUNT_PACKETS(format.companyId, count);
+
+    const size_t need = 2 + format.minPayloadLength;
+    size_t complete = 0;
+
+    for (size_t row = 0; row < count; row += BATCH_BLOCK_ROWS) {
+        size_t rows = (count - row < BATCH_BLOCK_ROWS) ? count - row : BATCH_BLOCK_ROWS;
+
+        bool allFull = true;
+        for (size_t r = 0; r < rows; ++r)
+            if (!packets[row + r] || lengths[row + r] < need) { allFull = false; break; }
+
+        if (allFull) {
+            const uint8_t* const* blockPackets = packets + row;
+            auto rowPtr = [blockPackets](size_t r) { return blockPackets[r] + 2; };
+            for (size_t i = 0; i < format.fields.size(); ++i)
+                decodeColumnBlock(format.fields[i], rowPtr, rows, columns[i] + row);
+            complete += rows;
+            continue;
+        }
+
+        for (size_t r = 0; r < rows; ++r) {
+            const uint8_t* pkt = packets[row + r];
+            size_t payloadLen = (pkt && lengths[row + r] >= 2) ? lengths[row + r] - 2 : 0;
+            size_t decoded = 0;
+
+            for (size_t i = 0; i < format.fields.size(); ++i) {
+                const CompiledField& f = format.fields[i];
+                if (payloadLen == 0 || static_cast<size_t>(f.offset) + f.size > payloadLen) {
+                    BLE_COUNT(FIELDS_OUT_OF_BOUNDS, 1);
+                    columns[i][row + r] = std::numeric_limits<float>::quiet_NaN();
+                    continue;
+                }
+                columns[i][row + r] = loadCompiledField(f, pkt + 2);
+                ++decoded;
+            }
+            if (decoded == format.fields.size()) ++complete;
+        }
+    }
+    return complete;
+}
+
+// Convenience overloads compiling the format once per call
+inline size_t decodeBatch(
+    const ManufacturerDataFormat& format,
+    const uint8_t* base,
+    size_t stride,
+    size_t count,
+    float* const* columns)
+{
+    return decodeBatch(CompiledFormat(format), base, stride, count, columns);
+}
+
+inline size_t decodeBatch(
+    const ManufacturerDataFormat& format,
+    const uint8_t* const* packets,
+    const size_t* lengths,
+    size_t count,
+    float* const* columns)
+{
+    return decodeBatch(CompiledFormat(format), packets, lengths, count, columns);
+}
+
+} // namespace BLEProfiles
@@ -0,0 +1,539 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring> // for memcmp
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompanyDispatch.h"
+#include "BLEProfileRegistry.h"
+#include "BLEReadingBatch.h"
+#include "BLEMappedFile.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Scan capture files
+// btsnoop (BlueZ btmon, Android HCI snoop log) and classic pcap
+// (tcpdump, Wireshark, Ubertooth / nRF sniffers). pcapng is not read.
+// -------------------------------------------------------------
+enum class CaptureFormat { UNKNOWN, BTSNOOP, PCAP };
+
+enum class CaptureLink {
+    UNSUPPORTED,
+    HCI_UNENCAPSULATED,   // btsnoop 1001: packet type in the record flags
+    HCI_H4,               // btsnoop 1002, pcap 187: H4 packet-type byte first
+    HCI_H4_WITH_PHDR,     // pcap 201: 4-byte direction header, then H4
+    HCI_MONITOR,          // btsnoop 2001 (btmon): opcode in the record flags
+    LE_LL,                // pcap 251: over-the-air link-layer packets
+    LE_LL_WITH_PHDR       // pcap 256: 10-byte radio header, then LE_LL
+};
+
+inline constexpr uint64_t BTSNOOP_UNIX_EPOCH_US   = 0x00DCDDB30F2F8000ull;   // btsnoop timestamp of 1970-01-01
+inline constexpr size_t   CAPTURE_MAX_RECORD_BYTES = 0x40000;                 // larger records mean a corrupt file
+inline constexpr int8_t   RSSI_UNAVAILABLE        = 127;                     // HCI "RSSI not available"
+
+struct CaptureRecord {
+    const uint8_t* data;   // captured bytes of the packet
+    size_t length;
+    uint32_t flags;        // btsnoop record flags, 0 for pcap
+    uint64_t timestamp;    // microseconds since the Unix epoch
+};
+
+// One manufacturer-data AD structure from an advertising report
+struct ScanAdvert {
+    DeviceAddress address;   // 48-bit device address | address type << 48
+    uint64_t timestamp;      // microseconds since the Unix epoch
+    int8_t rssi;             // RSSI_UNAVAILABLE when the capture has none
+    const uint8_t* data;     // manufacturer data, company ID prefix included
+    size_t length;
+};
+
+// -------------------------------------------------------------
+// Capture reader
+// Walks the records of a capture held in memory (see MappedFile).
+// -------------------------------------------------------------
+class CaptureReader {
+public:
+    CaptureReader()
+        : data_(nullptr), size_(0), format_(CaptureFormat::UNKNOWN), link_(CaptureLink::UNSUPPORTED),
+          swapped_(false), nanoseconds_(false), firstRecord_(0) {}
+
+    // Returns false for unknown file types and unsupported link types
+    bool open(const uint8_t* data, size_t size) {
+        *this = CaptureReader();
+        if (!data) return false;
+
+        if (size >= 16 && memcmp(data, "btsnoop\0", 8) == 0) {
+            if (loadUInt32(data + 8, true) != 1) return false;
+            switch (loadUInt32(data + 12, true)) {
+                case 1001: link_ = CaptureLink::HCI_UNENCAPSULATED; break;
+                case 1002: link_ = CaptureLink::HCI_H4; break;
+                case 2001: link_ = CaptureLink::HCI_MONITOR; break;
+                default: return false;
+            }
+            format_ = CaptureFormat::BTSNOOP;
+            firstRecord_ = 16;
+        } else if (size >= 24) {
+            switch (loadUInt32(data, false)) {
+                case 0xA1B2C3D4: break;
+                case 0xD4C3B2A1: swapped_ = true; break;
+                case 0xA1B23C4D: nanoseconds_ = true; break;
+                case 0x4D3CB2A1: swapped_ = true; nanoseconds_ = true; break;
+                default: return false;
+            }
+            switch (loadUInt32(data + 20, swapped_)) {
+                case 187: link_ = CaptureLink::HCI_H4; break;
+                case 201: link_ = CaptureLink::HCI_H4_WITH_PHDR; break;
+                case 251: link_ = CaptureLink::LE_LL; break;
+                case 256: link_ = CaptureLink::LE_LL_WITH_PHDR; break;
+                default: return false;
+            }
+            format_ = CaptureFormat::PCAP;
+            firstRecord_ = 24;
+        } else {
+            return false;
+        }
+        data_ = data;
+        size_ = size;
+        return true;
+    }
+
+    CaptureFormat format() const { return format_; }
+    CaptureLink link() const { return link_; }
+    size_t size() const { return size_; }
+
+    // Offset of the first record
+    size_t firstRecord() const { return firstRecord_; }
+
+    // Read the record at offset. Returns the offset of the next record, or 0
+    // when offset is at the end or the record is truncated or implausible.
+    size_t readRecord(size_t offset, CaptureRecord& rec) const {
+        if (format_ == CaptureFormat::BTSNOOP) {
+            if (offset + 24 > size_) return 0;
+            const uint8_t* h = data_ + offset;
+            size_t included = loadUInt32(h + 4, true);
+            if (included > CAPTURE_MAX_RECORD_BYTES || included > size_ - offset - 24) return 0;
+            uint64_t ts = (static_cast<uint64_t>(loadUInt32(h + 16, true)) << 32) | loadUInt32(h + 20, true);
+            rec.data = h + 24;
+            rec.length = included;
+            rec.flags = loadUInt32(h + 8, true);
+            rec.timestamp = ts - BTSNOOP_UNIX_EPOCH_US;
+            return offset + 24 + included;
+        }
+        if (format_ == CaptureFormat::PCAP) {
+            if (offset + 16 > size_) return 0;
+            const uint8_t* h = data_ + offset;
+            size_t included = loadUInt32(h + 8, swapped_);
+            if (included > CAPTURE_MAX_RECORD_BYTES || included > size_ - offset - 16) return 0;
+            uint64_t frac = loadUInt32(h + 4, swapped_);
+            rec.data = h + 16;
+            rec.length = included;
+            rec.flags = 0;
+            rec.timestamp = static_cast<uint64_t>(loadUInt32(h, swapped_)) * 1000000u + (nanoseconds_ ? frac / 1000 : frac);
+            return offset + 16 + included;
+        }
+        return 0;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    CaptureFormat format_;
+    CaptureLink link_;
+    bool swapped_;       // pcap written in the other byte order
+    bool nanoseconds_;   // pcap nanosecond-resolution timestamps
+    size_t firstRecord_;
+};
+
+// -------------------------------------------------------------
+// Advertising data parsing
+// -------------------------------------------------------------
+
+// Calls f(data, len) for every manufacturer-specific (type 0xFF) AD
+// structure of at least two bytes; stops at the first truncated one
+template <typename F>
+inline void forEachManufacturerData(const uint8_t* ad, size_t len, F&& f) {
+    size_t i = 0;
+    while (i < len) {
+        size_t field = ad[i];
+        if (field == 0 || field > len - i - 1) return;
+        if (ad[i + 1] == 0xFF && field >= 3) f(ad + i + 2, field - 1);
+        i += 1 + field;
+    }
+}
+
+inline DeviceAddress loadDeviceAddress(const uint8_t* p, uint8_t addressType) {
+    uint64_t a = 0;
+    for (int i = 5; i >= 0; --i) a = (a << 8) | p[i];
+    return a | (static_cast<uint64_t>(addressType) << 48);
+}
+
+// Calls f(const ScanAdvert&) for every manufacturer-data AD structure of
+// an HCI LE (extended) advertising report or LL advertising PDU in rec.
+// Other packets are ignored. Returns false when rec is a report / PDU
+// that is cut short.
+template <typename F>
+inline bool forEachScanAdvert(const CaptureReader& reader, const CaptureRecord& rec, F&& f) {
+    const uint8_t* p = rec.data;
+    size_t len = rec.length;
+    int8_t rssi = RSSI_UNAVAILABLE;
+
+    auto emit = [&](DeviceAddress address, int8_t r, const uint8_t* ad, size_t adLen) {
+        forEachManufacturerData(ad, adLen, [&](const uint8_t* data, size_t dataLen) {
+            f(ScanAdvert{ address, rec.timestamp, r, data, dataLen });
+        });
+    };
+
+    switch (reader.link()) {
+        case CaptureLink::HCI_UNENCAPSULATED:
+            if ((rec.flags & 3) != 3) return true;   // received command/event
+            break;
+        case CaptureLink::HCI_MONITOR:
+            if ((rec.flags & 0xFFFF) != 3) return true;   // monitor opcode: event packet
+            break;
+        case CaptureLink::HCI_H4_WITH_PHDR:
+            if (len < 4) return true;
+            p += 4; len -= 4;
+            [[fallthrough]];
+        case CaptureLink::HCI_H4:
+            if (len < 1 || p[0] != 0x04) return true;   // H4: event packet
+            p += 1; len -= 1;
+            break;
+        case CaptureLink::LE_LL_WITH_PHDR:
+            if (len < 10) return true;
+            if (loadUInt16(p + 8, false) & 0x0002) rssi = static_cast<int8_t>(p[1]);   // signal power valid
+            p += 10; len -= 10;
+            [[fallthrough]];
+        case CaptureLink::LE_LL: {
+            if (len < 6) return true;
+            const uint8_t header = p[4];
+            const size_t pduLen = p[5];
+            const uint8_t type = header & 0x0F;
+            // ADV_IND, ADV_NONCONN_IND, SCAN_RSP, ADV_SCAN_IND: AdvA then AdvData
+            if (type != 0 && type != 2 && type != 4 && type != 6) return true;
+            if (pduLen < 6 || pduLen > len - 6) return false;
+            emit(loadDeviceAddress(p + 6, (header >> 6) & 1), rssi, p + 12, pduLen - 6);
+            return true;
+        }
+        case CaptureLink::UNSUPPORTED:
+            return true;
+    }
+
+    // HCI event: code, parameter length, parameters
+    if (len < 2 || p[0] != 0x3E) return true;   // LE Meta event
+    size_t plen = p[1];
+    if (plen > len - 2 || plen < 2) return false;
+    const uint8_t* q = p + 3;
+    const uint8_t* end = p + 2 + plen;
+    const uint8_t subevent = p[2];
+    const size_t reports = *q++;
+
+    if (subevent == 0x02) {   // LE Advertising Report
+        for (size_t r = 0; r < reports; ++r) {
+            if (end - q < 9) return false;
+            const size_t dataLen = q[8];
+            if (static_cast<size_t>(end - q) < 10 + dataLen) return false;
+            emit(loadDeviceAddress(q + 2, q[1]), static_cast<int8_t>(q[9 + dataLen]), q + 9, dataLen);
+            q += 10 + dataLen;
+        }
+    } else if (subevent == 0x0D) {   // LE Extended Advertising Report
+        for (size_t r = 0; r < reports; ++r) {
+            if (end - q < 24) return false;
+            const size_t dataLen = q[23];
+            if (static_cast<size_t>(end - q) < 24 + dataLen) return false;
+            emit(loadDeviceAddress(q + 3, q[2]), static_cast<int8_t>(q[13]), q + 24, dataLen);
+            q += 24 + dataLen;
+        }
+    }
+    return true;
+}
+
+// -------------------------------------------------------------
+// Work-stealing task queues
+// One deque per worker: the owner takes from the front (file order),
+// idle workers steal from the back of the others. Tasks are whole
+// chunks, so a mutex per deque is cheap next to the work it guards.
+// -------------------------------------------------------------
+template <typename T>
+class WorkStealingQueues {
+public:
+    explicit WorkStealingQueues(size_t workers) : queues_(workers ? workers : 1) {}
+
+    WorkStealingQueues(const WorkStealingQueues&) = delete;
+    WorkStealingQueues& operator=(const WorkStealingQueues&) = delete;
+
+    size_t workerCount() const { return queues_.size(); }
+
+    void push(size_t worker, const T& task) {
+        Queue& q = queues_[worker % queues_.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(task);
+    }
+
+    // Own front first, then the back of the other queues; false when all are empty
+    bool pop(size_t worker, T& task) {
+        const size_t n = queues_.size();
+        {
+            Queue& q = queues_[worker % n];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                task = q.tasks.front();
+                q.tasks.pop_front();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < n; ++i) {
+            Queue& q = queues_[(worker + i) % n];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                task = q.tasks.back();
+                q.tasks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<T> tasks;
+    };
+    std::vector<Queue> queues_;
+};
+
+// -------------------------------------------------------------
+// Parallel capture replay
+// The calling thread walks the record headers, cuts the file into
+// chunks of about chunkBytes at record boundaries and deals them to
+// the workers' queues as it goes, so decoding runs right behind the
+// sequential read. Each worker decodes a chunk's adverts with the
+// registry's dispatch table into one ReadingBatch per company ID and
+// hands them to the sink. The sink runs on worker threads, may be
+// called concurrently, and sees chunks in any order (use
+// ReplayChunk::index to restore file order).
+//
+//   replayCaptureFile("scan.btsnoop", getProfileRegistry(),
+//                     [&](const ReplayChunk& chunk) { ... });
+// -------------------------------------------------------------
+struct ReplayOptions {
+    size_t threads;      // 0: std::thread::hardware_concurrency()
+    size_t chunkBytes;
+
+    ReplayOptions() : threads(0), chunkBytes(size_t(4) << 20) {}
+};
+
+struct ReplayStats {
+    uint64_t records;     // capture records read
+    uint64_t adverts;     // manufacturer-data AD structures found
+    uint64_t decoded;     // adverts appended to a batch
+    uint64_t unknown;     // adverts whose company ID has no compiled format
+    uint64_t malformed;   // advertising reports cut short
+    uint64_t chunks;
+    bool truncated;       // the capture ended inside a record
+};
+
+struct ReplayChunk {
+    size_t index;                                // ordinal in file order
+    size_t beginOffset;                          // byte range of the chunk's records
+    size_t endOffset;
+    std::vector<const ReadingBatch*> batches;     // non-empty batches, valid during the sink call
+    uint64_t records;
+    uint64_t adverts;
+    uint64_t unknown;
+    uint64_t malformed;
+};
+
+using ReplaySink = std::function<void(const ReplayChunk&)>;
+
+class CaptureReplayWorker {
+public:
+    CaptureReplayWorker(const CaptureReader& reader, const CompanyDispatchTable& dispatch)
+        : reader_(reader), dispatch_(dispatch), stats_{0, 0, 0, 0, 0, 0, false} {}
+
+    void run(size_t index, size_t begin, size_t end, const ReplaySink& sink) {
+        for (auto& route : routes_) route.clear();
+
+        ReplayChunk chunk;
+        chunk.index = index;
+        chunk.beginOffset = begin;
+        chunk.endOffset = end;
+        chunk.records = chunk.adverts = chunk.unknown = chunk.malformed = 0;
+
+        CaptureRecord rec;
+        for (size_t offset = begin; offset < end; ) {
+            size_t next = reader_.readRecord(offset, rec);
+            if (next == 0) break;   // cannot happen for ranges cut by replayCapture
+            offset = next;
+            ++chunk.records;
+            bool complete = forEachScanAdvert(reader_, rec, [&](const ScanAdvert& a) {
+                ++chunk.adverts;
+                const CompanyDispatchEntry* entry = dispatch_.find(static_cast<uint16_t>(a.data[0] | (a.data[1] << 8)));
+                if (!entry || entry->format.fields.empty()) { ++chunk.unknown; return; }
+                routeFor(entry).add(a);
+            });
+            if (!complete) ++chunk.malformed;
+        }
+
+        uint64_t decoded = 0;
+        for (auto& route : routes_) {
+            if (route.packets.empty()) continue;
+            route.batch->clear();
+            route.batch->append(route.devices.data(), route.timestamps.data(),
+                                route.packets.data(), route.lengths.data(), route.packets.size());
+            decoded += route.packets.size();
+            chunk.batches.push_back(route.batch.get());
+        }
+        if (sink) sink(chunk);
+
+        stats_.records += chunk.records;
+        stats_.adverts += chunk.adverts;
+        stats_.decoded += decoded;
+        stats_.unknown += chunk.unknown;
+        stats_.malformed += chunk.malformed;
+        ++stats_.chunks;
+    }
+
+    const ReplayStats& stats() const { return stats_; }
+
+private:
+    struct Route {
+        const CompanyDispatchEntry* entry;
+        std::unique_ptr<ReadingBatch> batch;
+        std::vector<DeviceAddress> devices;
+        std::vector<uint64_t> timestamps;
+        std::vector<const uint8_t*> packets;
+        std::vector<size_t> lengths;
+
+        void add(const ScanAdvert& a) {
+            devices.push_back(a.address);
+            timestamps.push_back(a.timestamp);
+            packets.push_back(a.data);
+            lengths.push_back(a.length);
+        }
+
+        void clear() {
+            devices.clear();
+            timestamps.clear();
+            packets.clear();
+            lengths.clear();
+        }
+    };
+
+    Route& routeFor(const CompanyDispatchEntry* entry) {
+        for (auto& r : routes_) if (r.entry == entry) return r;
+        routes_.emplace_back();
+        Route& r = routes_.back();
+        r.entry = entry;
+        r.batch.reset(new ReadingBatch(entry->format));
+        return r;
+    }
+
+    const CaptureReader& reader_;
+    const CompanyDispatchTable& dispatch_;
+    std::vector<Route> routes_;
+    ReplayStats stats_;
+};
+
+// Returns false when data is not a supported capture; stats are filled either way
+inline bool replayCapture(const uint8_t* data, size_t size, const ProfileRegistry& registry,
+                          const ReplaySink& sink, const ReplayOptions& options = ReplayOptions(),
+                          ReplayStats* stats = nullptr)
+{
+    ReplayStats total = { 0, 0, 0, 0, 0, 0, false };
+    CaptureReader reader;
+    if (!reader.open(data, size)) {
+        if (stats) *stats = total;
+        return false;
+    }
+
+    size_t threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    const size_t chunkBytes = options.chunkBytes ? options.chunkBytes : 1;
+
+    struct Task { size_t index, begin, end; };
+    WorkStealingQueues<Task> queues(threads);
+    std::atomic<bool> indexed(false);
+    std::vector<std::unique_ptr<CaptureReplayWorker>> workers;
+    for (size_t w = 0; w < threads; ++w)
+        workers.emplace_back(new CaptureReplayWorker(reader, registry.dispatch()));
+
+    std::vector<std::thread> pool;
+    for (size_t w = 0; w < threads; ++w) {
+        pool.emplace_back([&, w] {
+            CaptureReplayWorker& worker = *workers[w];
+            unsigned idleRounds = 0;
+            Task task;
+            for (;;) {
+                // Check 'indexed' before popping so a miss after it is final
+                bool last = indexed.load(std::memory_order_acquire);
+                if (queues.pop(w, task)) {
+                    worker.run(task.index, task.begin, task.end, sink);
+                    idleRounds = 0;
+                } else if (last) {
+                    return;
+                } else if (++idleRounds < 64) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+        });
+    }
+
+    size_t chunks = 0;
+    size_t offset = reader.firstRecord();
+    size_t begin = offset;
+    CaptureRecord rec;
+    while (offset < size) {
+        size_t next = reader.readRecord(offset, rec);
+        if (next == 0) { total.truncated = true; break; }
+        offset = next;
+        if (offset - begin >= chunkBytes) {
+            queues.push(chunks % threads, Task{ chunks, begin, offset });
+            ++chunks;
+            begin = offset;
+        }
+    }
+    if (offset > begin) {
+        queues.push(chunks % threads, Task{ chunks, begin, offset });
+        ++chunks;
+    }
+    indexed.store(true, std::memory_order_release);
+
+    for (auto& t : pool) t.join();
+    for (const auto& w : workers) {
+        const ReplayStats& s = w->stats();
+        total.records += s.records;
+        total.adverts += s.adverts;
+        total.decoded += s.decoded;
+        total.unknown += s.unknown;
+        total.malformed += s.malformed;
+        total.chunks += s.chunks;
+    }
+    if (stats) *stats = total;
+    return true;
+}
+
+inline bool replayCaptureFile(const std::string& path, const ProfileRegistry& registry,
+                              const ReplaySink& sink, const ReplayOptions& options = ReplayOptions(),
+                              ReplayStats* stats = nullptr)
+{
+    MappedFile file;
+    if (!file.open(path, true)) {
+        if (stats) *stats = ReplayStats{ 0, 0, 0, 0, 0, 0, false };
+        return false;
+    }
+    return replayCapture(file.data(), file.size(), registry, sink, options, stats);
+}
+
+} // namespace BLEProfiles
@@ -0,0 +1,163 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Company ID dispatch
+// Maps a company ID to its group and compiled format with one
+// multiply-shift hash probe. The multiplier is searched at build time
+// so the table is collision-free (a perfect hash over its keys);
+// unknown IDs land on a slot whose key does not match.
+// -------------------------------------------------------------
+struct CompanyDispatchEntry {
+    uint16_t companyId;
+    SensorGroup group;
+    CompiledFormat format;          // no fields when only the group is known
+    const DeviceProfile* profile;   // source profile when its owner outlives the table, else nullptr
+
+    CompanyDispatchEntry() : companyId(0), group(SensorGroup::UNKNOWN), profile(nullptr) {}
+    CompanyDispatchEntry(uint16_t id, SensorGroup g, const CompiledFormat& fmt = CompiledFormat(),
+                         const DeviceProfile* prof = nullptr)
+        : companyId(id), group(g), format(fmt), profile(prof) {}
+};
+
+class CompanyDispatchTable {
+public:
+    CompanyDispatchTable() : multiplier_(0), shift_(32) {}
+
+    // Entries with duplicate company IDs keep the first occurrence
+    explicit CompanyDispatchTable(const std::vector<CompanyDispatchEntry>& entries)
+        : multiplier_(0), shift_(32)
+    {
+        std::vector<CompanyDispatchEntry> unique;
+        std::vector<bool> seen(size_t(1) << 16, false);
+        for (const auto& e : entries) {
+            if (seen[e.companyId]) continue;
+            seen[e.companyId] = true;
+            unique.push_back(e);
+        }
+        if (unique.empty()) return;
+
+        // Load <= 0.5 where possible; past 32768 IDs the 16-bit table is the only fit
+        unsigned bits = 1;
+        while (bits < 16 && (1u << bits) < unique.size() * 2) ++bits;
+
+        // A 16-bit table with multiplier 1 << 16 maps every ID to itself,
+        // so the search always terminates
+        for (; bits <= 16; ++bits) {
+            if (bits == 16) {
+                if (tryBuild(unique, 16, 1u << 16)) return;
+            }
+            uint32_t m = 0x9E3779B1u;
+            for (int attempt = 0; attempt < 256; ++attempt) {
+                if (tryBuild(unique, bits, m | 1u)) return;
+                m = m * 1664525u + 1013904223u;
+            }
+        }
+    }
+
+    const CompanyDispatchEntry* find(uint16_t companyId) const {
+        if (!slots_.empty()) {
+            const Slot& s = slots_[slotIndex(companyId)];
+            if (s.used && s.entry.companyId == companyId) return &s.entry;
+        }
+        BLE_COUNT(UNKNOWN_COMPANY_IDS, 1);
+        return nullptr;
+    }
+
+    SensorGroup groupFor(uint16_t companyId) const {
+        const CompanyDispatchEntry* e = find(companyId);
+        return e ? e->group : SensorGroup::UNKNOWN;
+    }
+
+    const CompiledFormat* formatFor(uint16_t companyId) const {
+        const CompanyDispatchEntry* e = find(companyId);
+        return (e && !e->format.fields.empty()) ? &e->format : nullptr;
+    }
+
+    // Look up the company ID in the first two bytes of data and decode with
+    // its compiled format. Returns the number of fields decoded (0 for
+    // unknown IDs); *entry receives the matched entry or nullptr.
+    size_t decode(const uint8_t* data, size_t len, float* out,
+                  const CompanyDispatchEntry** entry = nullptr) const
+    {
+        const CompanyDispatchEntry* e = nullptr;
+        size_t decoded = 0;
+        if (data && len >= 2) {
+            e = find(static_cast<uint16_t>(data[0] | (data[1] << 8)));
+            if (e) decoded = e->format.decode(data, len, out);
+        }
+        if (entry) *entry = e;
+        return decoded;
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (const auto& s : slots_) if (s.used) ++n;
+        return n;
+    }
+
+    // Largest fieldCount() of any entry's format, for sizing value buffers
+    size_t maxFieldCount() const {
+        size_t n = 0;
+        for (const auto& s : slots_)
+            if (s.used && s.entry.format.fieldCount() > n) n = s.entry.format.fieldCount();
+        return n;
+    }
+
+private:
+    struct Slot {
+        bool used;
+        CompanyDispatchEntry entry;
+        Slot() : used(false) {}
+    };
+
+    size_t slotIndex(uint16_t companyId) const {
+        return static_cast<size_t>((static_cast<uint32_t>(companyId) * multiplier_) >> shift_);
+    }
+
+    bool tryBuild(const std::vector<CompanyDispatchEntry>& entries, unsigned bits, uint32_t multiplier) {
+        multiplier_ = multiplier;
+        shift_ = 32 - bits;
+        std::vector<Slot> slots(size_t(1) << bits);
+        for (const auto& e : entries) {
+            Slot& s = slots[slotIndex(e.companyId)];
+            if (s.used) return false;
+            s.used = true;
+            s.entry = e;
+        }
+        slots_.swap(slots);
+        return true;
+    }
+
+    uint32_t multiplier_;
+    unsigned shift_;
+    std::vector<Slot> slots_;
+};
+
+// -------------------------------------------------------------
+// Dispatch table over every known company ID and built-in profile
+// -------------------------------------------------------------
+inline CompanyDispatchTable buildDispatchTable(const std::vector<DeviceProfile>& profiles) {
+    std::vector<CompanyDispatchEntry> entries;
+    for (const auto& p : profiles) {
+        uint16_t id = p.manufacturerFormat.companyId;
+        entries.emplace_back(id, lookupGroupForCompanyId(id), CompiledFormat(p.manufacturerFormat));
+    }
+    // Known groups without a profile still resolve their group
+    for (size_t g = 0; g < KNOWN_GROUP_COUNT; ++g)
+        entries.emplace_back(GROUP_COMPANY_ID_TABLE[g], static_cast<SensorGroup>(g));
+    return CompanyDispatchTable(entries);
+}
+
+inline CompanyDispatchTable buildDispatchTable() {
+    return buildDispatchTable(getAllProfiles());
+}
+
+} // namespace BLEProfiles
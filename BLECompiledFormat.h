@@ -0,0 +1,305 @@
+#pragma once
+#include <vector>
+#include <limits>
+#include <type_traits>
+#include <cstdint>
+#include <cstring> // for memcpy, memset
+
+#include "BLEDeviceProfiles.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Per-field decoders (pointer points at the first byte of the field)
+// -------------------------------------------------------------
+using FieldDecoder = float (*)(const uint8_t* p);
+
+inline float decodeUInt8(const uint8_t* p)    { return static_cast<float>(p[0]); }
+inline float decodeInt8(const uint8_t* p)     { return static_cast<float>(static_cast<int8_t>(p[0])); }
+inline float decodeUInt16LE(const uint8_t* p) { return static_cast<float>(loadUInt16(p, false)); }
+inline float decodeUInt16BE(const uint8_t* p) { return static_cast<float>(loadUInt16(p, true)); }
+inline float decodeInt16LE(const uint8_t* p)  { return static_cast<float>(static_cast<int16_t>(loadUInt16(p, false))); }
+inline float decodeInt16BE(const uint8_t* p)  { return static_cast<float>(static_cast<int16_t>(loadUInt16(p, true))); }
+inline float decodeUInt32LE(const uint8_t* p) { return static_cast<float>(loadUInt32(p, false)); }
+inline float decodeUInt32BE(const uint8_t* p) { return static_cast<float>(loadUInt32(p, true)); }
+inline float decodeFloatLE(const uint8_t* p)  { return loadFloat(p, false); }
+inline float decodeFloatBE(const uint8_t* p)  { return loadFloat(p, true); }
+
+// Out-of-range DataType values decode as 0, same as parseField()
+inline float decodeUnsupported(const uint8_t*) {
+    BLE_COUNT(UNSUPPORTED_DATA_TYPES, 1);
+    return 0.0f;
+}
+
+inline FieldDecoder fieldDecoderFor(DataType dt) {
+    switch (dt) {
+        case DataType::UINT8:     return &decodeUInt8;
+        case DataType::INT8:      return &decodeInt8;
+        case DataType::UINT16_LE: return &decodeUInt16LE;
+        case DataType::UINT16_BE: return &decodeUInt16BE;
+        case DataType::INT16_LE:  return &decodeInt16LE;
+        case DataType::INT16_BE:  return &decodeInt16BE;
+        case DataType::UINT32_LE: return &decodeUInt32LE;
+        case DataType::UINT32_BE: return &decodeUInt32BE;
+        case DataType::FLOAT_LE:  return &decodeFloatLE;
+        case DataType::FLOAT_BE:  return &decodeFloatBE;
+        case DataType::UINT_BITS:
+        case DataType::INT_BITS:  break; // handled by loadCompiledField()
+    }
+    return &decodeUnsupported;
+}
+
+// -------------------------------------------------------------
+// Per-field encoders (value already multiplied by the inverse scale).
+// Integer types saturate with the type's range, see saturateRaw().
+// -------------------------------------------------------------
+using FieldEncoder = void (*)(uint8_t* p, float val);
+
+template <DataType T>
+inline uint32_t saturateAs(float val) {
+    constexpr bool wide = T == DataType::UINT32_LE || T == DataType::UINT32_BE;
+    using Int = typename std::conditional<wide, int64_t, int32_t>::type;
+    return static_cast<uint32_t>(saturateRaw<Int>(val, rawRangeFor(T)));
+}
+
+inline void encodeUInt8(uint8_t* p, float val)    { p[0] = static_cast<uint8_t>(saturateAs<DataType::UINT8>(val)); }
+inline void encodeInt8(uint8_t* p, float val)     { p[0] = static_cast<uint8_t>(saturateAs<DataType::INT8>(val)); }
+inline void encodeUInt16LE(uint8_t* p, float val) { storeUInt16(p, static_cast<uint16_t>(saturateAs<DataType::UINT16_LE>(val)), false); }
+inline void encodeUInt16BE(uint8_t* p, float val) { storeUInt16(p, static_cast<uint16_t>(saturateAs<DataType::UINT16_BE>(val)), true); }
+inline void encodeInt16LE(uint8_t* p, float val)  { storeUInt16(p, static_cast<uint16_t>(saturateAs<DataType::INT16_LE>(val)), false); }
+inline void encodeInt16BE(uint8_t* p, float val)  { storeUInt16(p, static_cast<uint16_t>(saturateAs<DataType::INT16_BE>(val)), true); }
+inline void encodeUInt32LE(uint8_t* p, float val) { storeUInt32(p, saturateAs<DataType::UINT32_LE>(val), false); }
+inline void encodeUInt32BE(uint8_t* p, float val) { storeUInt32(p, saturateAs<DataType::UINT32_BE>(val), true); }
+inline void encodeFloatLE(uint8_t* p, float val)  { storeFloat(p, val, false); }
+inline void encodeFloatBE(uint8_t* p, float val)  { storeFloat(p, val, true); }
+
+// Out-of-range DataType values stay zero-filled, same as packField()
+inline void encodeUnsupported(uint8_t*, float) { BLE_COUNT(UNSUPPORTED_DATA_TYPES, 1); }
+
+inline FieldEncoder fieldEncoderFor(DataType dt) {
+    switch (dt) {
+        case DataType::UINT8:     return &encodeUInt8;
+        case DataType::INT8:      return &encodeInt8;
+        case DataType::UINT16_LE: return &encodeUInt16LE;
+        case DataType::UINT16_BE: return &encodeUInt16BE;
+        case DataType::INT16_LE:  return &encodeInt16LE;
+        case DataType::INT16_BE:  return &encodeInt16BE;
+        case DataType::UINT32_LE: return &encodeUInt32LE;
+        case DataType::UINT32_BE: return &encodeUInt32BE;
+        case DataType::FLOAT_LE:  return &encodeFloatLE;
+        case DataType::FLOAT_BE:  return &encodeFloatBE;
+        case DataType::UINT_BITS:
+        case DataType::INT_BITS:  break; // handled by storeCompiledField()
+    }
+    return &encodeUnsupported;
+}
+
+// -------------------------------------------------------------
+// Compiled format: a ManufacturerDataFormat flattened once into
+// offsets, decoder pointers and effective scales
+// -------------------------------------------------------------
+struct CompiledField {
+    uint16_t offset;      // offset into the payload (after the company ID)
+    uint8_t size;         // fieldByteSize(): bytes touched starting at offset
+    DataType dataType;
+    SensorNameId nameId;
+    float scale;          // effective scale, 0 already replaced by 1
+    float invScale;       // 1 / scale, so encoding multiplies
+    RawRange range;       // rawRangeFor(dataType, bitWidth); bit fields saturate to it
+    FieldDecoder decode;
+    FieldEncoder encode;
+    uint8_t bitOffset;    // bit fields only; bitWidth is 0 for byte-aligned types
+    uint8_t bitWidth;
+    uint32_t bitMask;     // bitMaskFor(bitWidth)
+    uint32_t signBit;     // INT_BITS: top bit of the field, else 0
+};
+
+// Flatten one field description; bitOffset / bitWidth are ignored for byte-aligned
+// types and clamped to 0-7 / 1-32 for bit fields, so size is 1 to 5
+inline CompiledField makeCompiledField(uint16_t offset, DataType dataType, float scale,
+                                       uint8_t bitOffset, uint8_t bitWidth, SensorNameId nameId)
+{
+    const bool bits = isBitFieldType(dataType);
+    bitOffset = clampBitOffset(bitOffset);
+    bitWidth  = clampBitWidth(bitWidth);
+    CompiledField cf;
+    cf.offset    = offset;
+    cf.size      = static_cast<uint8_t>(bits ? bitFieldByteSpan(bitOffset, bitWidth) : dataTypeSize(dataType));
+    cf.dataType  = dataType;
+    cf.nameId    = nameId;
+    cf.scale     = (scale != 0.0f) ? scale : 1.0f;
+    cf.invScale  = 1.0f / cf.scale;
+    cf.decode    = fieldDecoderFor(dataType);
+    cf.encode    = fieldEncoderFor(dataType);
+    cf.bitOffset = bits ? bitOffset : 0;
+    cf.bitWidth  = bits ? bitWidth : 0;
+    cf.bitMask   = bitMaskFor(cf.bitWidth);
+    cf.signBit   = (dataType == DataType::INT_BITS && cf.bitWidth) ? 1u << (cf.bitWidth - 1) : 0;
+    cf.range     = rawRangeFor(dataType, cf.bitWidth);
+    return cf;
+}
+
+// Raw bits of a bit field; p points at its first byte
+inline uint32_t loadFieldBits(const CompiledField& f, const uint8_t* p) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < f.size; ++i) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return static_cast<uint32_t>(v >> f.bitOffset) & f.bitMask;
+}
+
+// Bit field sign-extended through signBit (no-op for UINT_BITS)
+inline int32_t signedFieldBits(const CompiledField& f, uint32_t raw) {
+    return static_cast<int32_t>((raw ^ f.signBit) - f.signBit);
+}
+
+// Scaled value of f; p points at the field's first byte (f.size bytes readable)
+inline float loadCompiledFieldAt(const CompiledField& f, const uint8_t* p) {
+    if (f.bitWidth == 0) return f.decode(p) * f.scale;
+    uint32_t raw = loadFieldBits(f, p);
+    return (f.signBit ? static_cast<float>(signedFieldBits(f, raw)) : static_cast<float>(raw)) * f.scale;
+}
+
+// Scaled value of f read from payload (the bytes after the company ID)
+inline float loadCompiledField(const CompiledField& f, const uint8_t* payload) {
+    return loadCompiledFieldAt(f, payload + f.offset);
+}
+
+// Write value (in sensor units) of f into payload, saturated to the field's
+// range; bit fields keep neighbouring bits
+inline void storeCompiledField(const CompiledField& f, uint8_t* payload, float value) {
+    uint8_t* p = payload + f.offset;
+    if (f.bitWidth == 0) { f.encode(p, value * f.invScale); return; }
+    storeBits(p, f.bitOffset, f.bitWidth, static_cast<uint32_t>(saturateRaw(value * f.invScale, f.range)));
+}
+
+// Zero the field's bits / bytes
+inline void clearCompiledField(const CompiledField& f, uint8_t* payload) {
+    uint8_t* p = payload + f.offset;
+    if (f.bitWidth == 0) { memset(p, 0, f.size); return; }
+    storeBits(p, f.bitOffset, f.bitWidth, 0);
+}
+
+struct CompiledFormat {
+    uint16_t companyId;
+    uint16_t totalLength;
+    size_t minPayloadLength;   // end of the last field; payloads at least this long need no per-field checks
+    std::vector<CompiledField> fields;
+
+    CompiledFormat() : companyId(0), totalLength(0), minPayloadLength(0) {}
+
+    explicit CompiledFormat(const ManufacturerDataFormat& format)
+        : companyId(format.companyId), totalLength(format.totalLength), minPayloadLength(0)
+    {
+        fields.reserve(format.dataFields.size());
+        for (const auto& f : format.dataFields) {
+            CompiledField cf = makeCompiledField(f.offset, f.dataType, f.scale,
+                                                 f.bitOffset, f.bitWidth, f.nameId);
+            fields.push_back(cf);
+
+            size_t end = static_cast<size_t>(cf.offset) + cf.size;
+            if (end > minPayloadLength) minPayloadLength = end;
+        }
+    }
+
+    size_t fieldCount() const { return fields.size(); }
+
+    // Ordinal of the field with the given interned name, or fieldCount() when absent
+    size_t indexOf(SensorNameId id) const {
+        for (size_t i = 0; i < fields.size(); ++i)
+            if (fields[i].nameId == id) return i;
+        return fields.size();
+    }
+
+    // Decode manufacturer data (including the 2-byte company ID prefix) into
+    // out[0..fieldCount()), indexed by field ordinal in the source format.
+    // Fields that do not fit in a short payload are set to NaN.
+    // Returns the number of fields decoded. Never allocates.
+    size_t decode(const uint8_t* data, size_t len, float* out) const {
+        BLE_COUNT_CYCLES(PARSE_CALLS, PARSE_CYCLES);
+        if (!data || len < 2) {
+            for (size_t i = 0; i < fields.size(); ++i)
+                out[i] = std::numeric_limits<float>::quiet_NaN();
+            return 0;
+        }
+        BLE_COUNT_PACKETS(data[0] | (data[1] << 8), 1);
+
+        const uint8_t* payload = data + 2;
+        size_t payloadLen = len - 2;
+
+        if (payloadLen >= minPayloadLength) {
+            for (size_t i = 0; i < fields.size(); ++i) {
+                const CompiledField& f = fields[i];
+                out[i] = loadCompiledField(f, payload);
+            }
+            return fields.size();
+        }
+
+        size_t decoded = 0;
+        for (size_t i = 0; i < fields.size(); ++i) {
+            const CompiledField& f = fields[i];
+            if (static_cast<size_t>(f.offset) + f.size > payloadLen) {
+                BLE_COUNT(FIELDS_OUT_OF_BOUNDS, 1);
+                out[i] = std::numeric_limits<float>::quiet_NaN();
+                continue;
+            }
+            out[i] = loadCompiledField(f, payload);
+            ++decoded;
+        }
+        return decoded;
+    }
+
+    // Decode into ID-tagged readings; fields that do not fit are omitted.
+    // Returns the number of readings written (at most fieldCount()).
+    size_t decode(const uint8_t* data, size_t len, SensorReading* out) const {
+        BLE_COUNT_CYCLES(PARSE_CALLS, PARSE_CYCLES);
+        if (!data || len < 2) return 0;
+        BLE_COUNT_PACKETS(data[0] | (data[1] << 8), 1);
+
+        const uint8_t* payload = data + 2;
+        size_t payloadLen = len - 2;
+
+        if (payloadLen >= minPayloadLength) {
+            for (size_t i = 0; i < fields.size(); ++i)
+                out[i] = { fields[i].nameId, loadCompiledField(fields[i], payload) };
+            return fields.size();
+        }
+
+        size_t count = 0;
+        for (const CompiledField& f : fields) {
+            if (static_cast<size_t>(f.offset) + f.size > payloadLen) {
+                BLE_COUNT(FIELDS_OUT_OF_BOUNDS, 1);
+                continue;
+            }
+            out[count++] = { f.nameId, loadCompiledField(f, payload) };
+        }
+        return count;
+    }
+
+    // Encode values[0..fieldCount()) into out (company ID prefix + totalLength
+    // bytes); NaN values leave their field zero-filled. Returns bytes written,
+    // or 0 when capacity is too small or a field lies past totalLength.
+    // Never allocates.
+    size_t encode(const float* values, uint8_t* out, size_t capacity) const {
+        BLE_COUNT_CYCLES(PACK_CALLS, PACK_CYCLES);
+        size_t len = 2 + static_cast<size_t>(totalLength);
+        if (!out || capacity < len || minPayloadLength > totalLength) return 0;
+        BLE_COUNT(PACKETS_PACKED, 1);
+
+        memset(out, 0, len);
+        out[0] = static_cast<uint8_t>(companyId & 0xFF);
+        out[1] = static_cast<uint8_t>((companyId >> 8) & 0xFF);
+
+        uint8_t* payload = out + 2;
+        for (size_t i = 0; i < fields.size(); ++i) {
+            const CompiledField& f = fields[i];
+            if (values[i] != values[i]) continue; // NaN: no value for this field
+            storeCompiledField(f, payload, values[i]);
+        }
+        return len;
+    }
+};
+
+inline CompiledFormat compileFormat(const ManufacturerDataFormat& format) {
+    return CompiledFormat(format);
+}
+
+} // namespace BLEProfiles
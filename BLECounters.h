@@ -0,0 +1,230 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+// -------------------------------------------------------------
+// Hot-path instrumentation counters
+// Compiled out unless BLE_PROFILES_ENABLE_COUNTERS is set to 1 before
+// the first include; the BLE_COUNT* macros then expand to nothing and
+// snapshotCounters() returns zeros. When enabled, every thread counts
+// into its own block (single writer, relaxed load/store, no RMW), and
+// snapshotCounters() sums the live blocks plus exited threads.
+// -------------------------------------------------------------
+#ifndef BLE_PROFILES_ENABLE_COUNTERS
+#define BLE_PROFILES_ENABLE_COUNTERS 0
+#endif
+
+#if BLE_PROFILES_ENABLE_COUNTERS
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+namespace BLEProfiles {
+
+enum class CounterKind : unsigned {
+    PACKETS_PARSED,          // parse/decode calls that reached the field loop
+    PACKETS_PACKED,
+    FIELDS_OUT_OF_BOUNDS,    // fields skipped by the offset + size bounds checks
+    UNKNOWN_COMPANY_IDS,     // lookups that resolved to SensorGroup::UNKNOWN / no entry
+    UNSUPPORTED_DATA_TYPES,  // values that fell through the DataType switches
+    PARSE_CALLS,             // calls timed into PARSE_CYCLES
+    PARSE_CYCLES,
+    PACK_CALLS,
+    PACK_CYCLES,
+    COUNT
+};
+
+inline constexpr bool COUNTERS_ENABLED = BLE_PROFILES_ENABLE_COUNTERS != 0;
+inline constexpr size_t COUNTER_KIND_COUNT = static_cast<size_t>(CounterKind::COUNT);
+inline constexpr size_t COMPANY_COUNTER_SLOTS = 64;   // per thread; further IDs go to otherCompanyPackets
+
+struct CompanyPacketCount {
+    uint16_t companyId;
+    uint64_t packets;
+};
+
+struct CounterSnapshot {
+    uint64_t values[COUNTER_KIND_COUNT];
+    std::vector<CompanyPacketCount> packetsByCompany;   // ascending company ID
+    uint64_t otherCompanyPackets;
+
+    CounterSnapshot() : values{}, otherCompanyPackets(0) {}
+
+    uint64_t operator[](CounterKind k) const { return values[static_cast<size_t>(k)]; }
+
+    double cyclesPerParse() const {
+        uint64_t calls = (*this)[CounterKind::PARSE_CALLS];
+        return calls ? static_cast<double>((*this)[CounterKind::PARSE_CYCLES]) / calls : 0.0;
+    }
+
+    double cyclesPerPack() const {
+        uint64_t calls = (*this)[CounterKind::PACK_CALLS];
+        return calls ? static_cast<double>((*this)[CounterKind::PACK_CYCLES]) / calls : 0.0;
+    }
+};
+
+#if BLE_PROFILES_ENABLE_COUNTERS
+
+// TSC on x86, virtual counter on AArch64, steady_clock nanoseconds elsewhere
+inline uint64_t readCycleCounter() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+struct ThreadCounterBlock {
+    std::atomic<uint64_t> values[COUNTER_KIND_COUNT];
+    std::atomic<uint32_t> companyKeys[COMPANY_COUNTER_SLOTS];   // companyId + 1, 0 = free
+    std::atomic<uint64_t> companyPackets[COMPANY_COUNTER_SLOTS];
+    std::atomic<uint64_t> otherCompanyPackets;
+
+    ThreadCounterBlock() : otherCompanyPackets(0) {
+        for (auto& v : values) v.store(0, std::memory_order_relaxed);
+        for (auto& k : companyKeys) k.store(0, std::memory_order_relaxed);
+        for (auto& p : companyPackets) p.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Only the owning thread writes, so a relaxed load/store pair is enough
+inline void bumpCounter(std::atomic<uint64_t>& c, uint64_t n) {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+struct CounterRegistry {
+    std::mutex mutex;
+    std::vector<const ThreadCounterBlock*> live;
+    uint64_t retired[COUNTER_KIND_COUNT] = {};
+    std::map<uint16_t, uint64_t> retiredCompanies;
+    uint64_t retiredOther = 0;
+};
+
+inline CounterRegistry& counterRegistry() {
+    static CounterRegistry registry;
+    return registry;
+}
+
+inline void addBlockTo(const ThreadCounterBlock& b, uint64_t* values,
+                       std::map<uint16_t, uint64_t>& companies, uint64_t& other) {
+    for (size_t i = 0; i < COUNTER_KIND_COUNT; ++i) values[i] += b.values[i].load(std::memory_order_relaxed);
+    for (size_t s = 0; s < COMPANY_COUNTER_SLOTS; ++s) {
+        uint32_t key = b.companyKeys[s].load(std::memory_order_acquire);
+        if (key) companies[static_cast<uint16_t>(key - 1)] += b.companyPackets[s].load(std::memory_order_relaxed);
+    }
+    other += b.otherCompanyPackets.load(std::memory_order_relaxed);
+}
+
+// Registers on first use in a thread, folds into the retired totals at thread exit
+struct ThreadCounterRegistration {
+    ThreadCounterBlock block;
+
+    ThreadCounterRegistration() {
+        CounterRegistry& r = counterRegistry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(&block);
+    }
+
+    ~ThreadCounterRegistration() {
+        CounterRegistry& r = counterRegistry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        addBlockTo(block, r.retired, r.retiredCompanies, r.retiredOther);
+        for (size_t i = 0; i < r.live.size(); ++i) {
+            if (r.live[i] == &block) { r.live.erase(r.live.begin() + i); break; }
+        }
+    }
+};
+
+inline ThreadCounterBlock& threadCounters() {
+    thread_local ThreadCounterRegistration registration;
+    return registration.block;
+}
+
+inline void counterAdd(CounterKind kind, uint64_t n) {
+    bumpCounter(threadCounters().values[static_cast<size_t>(kind)], n);
+}
+
+inline void countCompanyPackets(uint16_t companyId, uint64_t n) {
+    ThreadCounterBlock& b = threadCounters();
+    bumpCounter(b.values[static_cast<size_t>(CounterKind::PACKETS_PARSED)], n);
+    const uint32_t key = static_cast<uint32_t>(companyId) + 1;
+    size_t s = (companyId * 0x9E37u >> 4) % COMPANY_COUNTER_SLOTS;
+    for (size_t probe = 0; probe < COMPANY_COUNTER_SLOTS; ++probe, s = (s + 1) % COMPANY_COUNTER_SLOTS) {
+        uint32_t k = b.companyKeys[s].load(std::memory_order_relaxed);
+        if (k == key) { bumpCounter(b.companyPackets[s], n); return; }
+        if (k == 0) {
+            // Count before publishing the key so a snapshot never sees a key without its packets
+            bumpCounter(b.companyPackets[s], n);
+            b.companyKeys[s].store(key, std::memory_order_release);
+            return;
+        }
+    }
+    bumpCounter(b.otherCompanyPackets, n);
+}
+
+// Adds the cycles spent in its scope to one counter and a call to another
+class CycleScope {
+public:
+    CycleScope(CounterKind calls, CounterKind cycles)
+        : calls_(calls), cycles_(cycles), start_(readCycleCounter()) {}
+    ~CycleScope() {
+        uint64_t elapsed = readCycleCounter() - start_;
+        ThreadCounterBlock& b = threadCounters();
+        bumpCounter(b.values[static_cast<size_t>(calls_)], 1);
+        bumpCounter(b.values[static_cast<size_t>(cycles_)], elapsed);
+    }
+    CycleScope(const CycleScope&) = delete;
+    CycleScope& operator=(const CycleScope&) = delete;
+
+private:
+    CounterKind calls_;
+    CounterKind cycles_;
+    uint64_t start_;
+};
+
+// Totals over every thread that has counted so far. Counters only grow;
+// scrapers take differences between snapshots.
+inline CounterSnapshot snapshotCounters() {
+    CounterRegistry& r = counterRegistry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    CounterSnapshot snap;
+    for (size_t i = 0; i < COUNTER_KIND_COUNT; ++i) snap.values[i] = r.retired[i];
+    std::map<uint16_t, uint64_t> companies = r.retiredCompanies;
+    snap.otherCompanyPackets = r.retiredOther;
+    for (const ThreadCounterBlock* b : r.live) addBlockTo(*b, snap.values, companies, snap.otherCompanyPackets);
+    for (const auto& kv : companies) snap.packetsByCompany.push_back({ kv.first, kv.second });
+    return snap;
+}
+
+#define BLE_COUNT(kind, n) ::BLEProfiles::counterAdd(::BLEProfiles::CounterKind::kind, (n))
+#define BLE_COUNT_PACKETS(companyId, n) ::BLEProfiles::countCompanyPackets(static_cast<uint16_t>(companyId), (n))
+#define BLE_COUNT_CYCLES(calls, cycles) \
+    ::BLEProfiles::CycleScope bleCycleScope_(::BLEProfiles::CounterKind::calls, ::BLEProfiles::CounterKind::cycles)
+
+#else
+
+inline CounterSnapshot snapshotCounters() { return CounterSnapshot(); }
+
+#define BLE_COUNT(kind, n) ((void)0)
+#define BLE_COUNT_PACKETS(companyId, n) ((void)0)
+#define BLE_COUNT_CYCLES(calls, cycles) ((void)0)
+
+#endif
+
+} // namespace BLEProfiles
@@ -0,0 +1,284 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstddef>
+#include <cstring> // for memcpy, memset
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Delta / varint codec for slowly changing fields
+// Frames start with one header byte after the company ID:
+//
+//   keyframe: [company ID:2][0x80 | seq:1][absolute payload: totalLength]
+//   delta:    [company ID:2][seq:1][field 0][field 1]...[field N-1]
+//
+// seq (7 bits, wrapping) numbers keyframes; a delta frame carries the
+// seq of the keyframe it is relative to, so a lost delta frame costs
+// nothing and a lost keyframe is detected instead of misdecoded.
+// In delta frames every field is written in format order:
+//   DELTA_VARINT integer fields  zigzag varint of (raw - keyframe raw)
+//   other integer fields         zigzag varint of raw
+//   FLOAT fields                 4 bytes in their own byte order
+// "raw" is the integer as stored in the absolute layout (before scale).
+// -------------------------------------------------------------
+inline constexpr uint8_t DELTA_KEYFRAME_FLAG   = 0x80;
+inline constexpr uint8_t DELTA_SEQUENCE_MASK   = 0x7F;
+inline constexpr size_t  DELTA_HEADER_LENGTH   = 1;
+inline constexpr size_t  VARINT_MAX_BYTES      = 10;
+
+inline uint64_t zigzagEncode(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+// LEB128. Returns bytes written, 0 when capacity is too small.
+inline size_t writeVarint(uint8_t* out, size_t capacity, uint64_t v) {
+    size_t n = 0;
+    do {
+        if (n >= capacity) return 0;
+        uint8_t b = static_cast<uint8_t>(v & 0x7F);
+        v >>= 7;
+        out[n++] = static_cast<uint8_t>(b | (v ? 0x80 : 0));
+    } while (v);
+    return n;
+}
+
+// Returns bytes consumed, 0 for truncated or over-long input
+inline size_t readVarint(const uint8_t* p, size_t len, uint64_t& v) {
+    v = 0;
+    for (size_t n = 0; n < len && n < VARINT_MAX_BYTES; ++n) {
+        v |= static_cast<uint64_t>(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) return n + 1;
+    }
+    return 0;
+}
+
+inline bool usesDelta(const DataFieldConfig& field) {
+    return field.encoding == FieldEncoding::DELTA_VARINT && !isFloatType(field.dataType);
+}
+
+inline bool formatFitsAbsoluteLayout(const ManufacturerDataFormat& format) {
+    for (const auto& f : format.dataFields)
+        if (f.offset + fieldByteSize(f) > format.totalLength) return false;
+    return true;
+}
+
+// -------------------------------------------------------------
+// Sender side: one encoder per advertising device and profile
+//
+//   DeltaEncoder enc(profile.manufacturerFormat, 16);
+//   size_t n = enc.encode(values, buf, sizeof(buf));
+// -------------------------------------------------------------
+class DeltaEncoder {
+public:
+    // A keyframe is sent at least every keyframeInterval frames (0 or 1: always)
+    explicit DeltaEncoder(const ManufacturerDataFormat& format, uint16_t keyframeInterval = 16)
+        : format_(format), keyframeInterval_(keyframeInterval),
+          framesSinceKeyframe_(0), sequence_(0), hasKeyframe_(false),
+          keyRaw_(format.dataFields.size(), 0),
+          scratch_(2 + static_cast<size_t>(format.totalLength), 0) {}
+
+    size_t keyframeLength() const { return 2 + DELTA_HEADER_LENGTH + format_.totalLength; }
+
+    // Worst-case frame length, for sizing output buffers
+    size_t maxFrameLength() const {
+        size_t delta = 2 + DELTA_HEADER_LENGTH;
+        for (const auto& f : format_.dataFields) delta += isFloatType(f.dataType) ? 4 : VARINT_MAX_BYTES;
+        return delta > keyframeLength() ? delta : keyframeLength();
+    }
+
+    // Next encode() emits a keyframe, e.g. after a receiver joined
+    void forceKeyframe() { framesSinceKeyframe_ = keyframeInterval_; }
+
+    // Encode values[0..fieldCount) (NaN: field zero, as in packManufacturerData).
+    // Returns bytes written, or 0 when capacity is too small or a field lies
+    // past totalLength. A delta frame is only sent when shorter than a keyframe.
+    size_t encode(const float* values, uint8_t* out, size_t capacity) {
+        size_t count = format_.dataFields.size();
+        if (!out || !packManufacturerData(values, count, format_, scratch_.data(), scratch_.size()) ||
+            !formatFitsAbsoluteLayout(format_))
+            return 0;
+
+        const uint8_t* payload = scratch_.data() + 2;
+        bool keyframe = !hasKeyframe_ || keyframeInterval_ <= 1 ||
+                        framesSinceKeyframe_ + 1 >= keyframeInterval_;
+
+        if (!keyframe) {
+            size_t n = encodeDelta(payload, out, capacity < keyframeLength() ? capacity : keyframeLength() - 1);
+            if (n) { ++framesSinceKeyframe_; return n; }
+            // Delta frame would not be shorter (or does not fit): fall back to a keyframe
+        }
+
+        if (capacity < keyframeLength()) return 0;
+        if (hasKeyframe_) sequence_ = static_cast<uint8_t>((sequence_ + 1) & DELTA_SEQUENCE_MASK);
+        out[0] = scratch_[0];
+        out[1] = scratch_[1];
+        out[2] = static_cast<uint8_t>(DELTA_KEYFRAME_FLAG | sequence_);
+        memcpy(out + 3, payload, format_.totalLength);
+        for (size_t i = 0; i < count; ++i) keyRaw_[i] = loadFieldRaw(payload, format_.dataFields[i]);
+        hasKeyframe_ = true;
+        framesSinceKeyframe_ = 0;
+        return keyframeLength();
+    }
+
+    const ManufacturerDataFormat& format() const { return format_; }
+
+private:
+    size_t encodeDelta(const uint8_t* payload, uint8_t* out, size_t capacity) const {
+        if (capacity < 2 + DELTA_HEADER_LENGTH) return 0;
+        out[0] = scratch_[0];
+        out[1] = scratch_[1];
+        out[2] = sequence_;
+        size_t pos = 2 + DELTA_HEADER_LENGTH;
+
+        for (size_t i = 0; i < format_.dataFields.size(); ++i) {
+            const DataFieldConfig& f = format_.dataFields[i];
+            if (isFloatType(f.dataType)) {
+                if (capacity - pos < 4) return 0;
+                memcpy(out + pos, payload + f.offset, 4);
+                pos += 4;
+                continue;
+            }
+            int64_t raw = loadFieldRaw(payload, f);
+            if (usesDelta(f)) raw -= keyRaw_[i];
+            size_t n = writeVarint(out + pos, capacity - pos, zigzagEncode(raw));
+            if (!n) return 0;
+            pos += n;
+        }
+        return pos;
+    }
+
+    ManufacturerDataFormat format_;
+    uint16_t keyframeInterval_;
+    uint16_t framesSinceKeyframe_;
+    uint8_t sequence_;
+    bool hasKeyframe_;
+    std::vector<int64_t> keyRaw_;
+    std::vector<uint8_t> scratch_;   // absolute layout of the current frame
+};
+
+// -------------------------------------------------------------
+// Receiver side: decoder state for one device
+// Decoded frames are expanded back into the absolute layout, so
+// absoluteData() can also be fed to any of the stateless parsers.
+// -------------------------------------------------------------
+class DeltaDecoder {
+public:
+    explicit DeltaDecoder(const ManufacturerDataFormat& format)
+        : format_(format), compiled_(format), hasKeyframe_(false), sequence_(0),
+          keyRaw_(format.dataFields.size(), 0), pending_(format.dataFields.size(), 0),
+          absolute_(2 + static_cast<size_t>(format.totalLength), 0) {}
+
+    // Decode one frame into out[0..fieldCount()). Returns the number of
+    // fields decoded; 0 for malformed frames (including delta frames with
+    // trailing bytes) and for delta frames whose keyframe was not received
+    // (out is left untouched).
+    size_t decode(const uint8_t* data, size_t len, float* out) {
+        if (!expand(data, len)) return 0;
+        return compiled_.decode(absolute_.data(), absolute_.size(), out);
+    }
+
+    // Expand a frame into absoluteData() without decoding values
+    bool expand(const uint8_t* data, size_t len) {
+        if (!data || len < 2 + DELTA_HEADER_LENGTH || !formatFitsAbsoluteLayout(format_)) return false;
+        uint8_t header = data[2];
+        uint8_t seq = header & DELTA_SEQUENCE_MASK;
+        const uint8_t* body = data + 2 + DELTA_HEADER_LENGTH;
+        size_t bodyLen = len - 2 - DELTA_HEADER_LENGTH;
+
+        if (header & DELTA_KEYFRAME_FLAG) {
+            if (bodyLen < format_.totalLength) return false;
+            absolute_[0] = data[0];
+            absolute_[1] = data[1];
+            memcpy(absolute_.data() + 2, body, format_.totalLength);
+            for (size_t i = 0; i < keyRaw_.size(); ++i)
+                keyRaw_[i] = loadFieldRaw(absolute_.data() + 2, format_.dataFields[i]);
+            sequence_ = seq;
+            hasKeyframe_ = true;
+            return true;
+        }
+
+        if (!hasKeyframe_ || seq != sequence_) return false;
+
+        // Parse into pending_ first so a truncated frame leaves absoluteData() untouched
+        std::vector<int64_t>& raws = pending_;
+        size_t pos = 0;
+        for (size_t i = 0; i < keyRaw_.size(); ++i) {
+            const DataFieldConfig& f = format_.dataFields[i];
+            if (isFloatType(f.dataType)) {
+                if (bodyLen - pos < 4) return false;
+                raws[i] = loadUInt32(body + pos, f.dataType == DataType::FLOAT_BE);
+                pos += 4;
+                continue;
+            }
+            uint64_t v;
+            size_t n = readVarint(body + pos, bodyLen - pos, v);
+            if (!n) return false;
+            pos += n;
+            raws[i] = zigzagDecode(v) + (usesDelta(f) ? keyRaw_[i] : 0);
+        }
+        if (pos != bodyLen) return false;   // trailing bytes: not a frame of this format
+
+        absolute_[0] = data[0];
+        absolute_[1] = data[1];
+        memset(absolute_.data() + 2, 0, format_.totalLength);
+        for (size_t i = 0; i < raws.size(); ++i)
+            storeFieldRaw(absolute_.data() + 2, format_.dataFields[i], raws[i]);
+        return true;
+    }
+
+    void reset() { hasKeyframe_ = false; }
+    bool hasKeyframe() const { return hasKeyframe_; }
+
+    // Last successfully expanded frame in the absolute layout, company ID included
+    const uint8_t* absoluteData() const { return absolute_.data(); }
+    size_t absoluteSize() const { return absolute_.size(); }
+
+    size_t fieldCount() const { return compiled_.fieldCount(); }
+
+private:
+    ManufacturerDataFormat format_;
+    CompiledFormat compiled_;
+    bool hasKeyframe_;
+    uint8_t sequence_;
+    std::vector<int64_t> keyRaw_;
+    std::vector<int64_t> pending_;
+    std::vector<uint8_t> absolute_;
+};
+
+// -------------------------------------------------------------
+// Per-device decoder state keyed by device address
+// -------------------------------------------------------------
+class DeltaDecoderMap {
+public:
+    explicit DeltaDecoderMap(const ManufacturerDataFormat& format) : format_(format) {}
+
+    size_t decode(DeviceAddress deviceAddress, const uint8_t* data, size_t len, float* out) {
+        auto it = decoders_.find(deviceAddress);
+        if (it == decoders_.end()) it = decoders_.emplace(deviceAddress, DeltaDecoder(format_)).first;
+        return it->second.decode(data, len, out);
+    }
+
+    // nullptr when the device has not been seen
+    const DeltaDecoder* find(DeviceAddress deviceAddress) const {
+        auto it = decoders_.find(deviceAddress);
+        return it != decoders_.end() ? &it->second : nullptr;
+    }
+
+    void erase(DeviceAddress deviceAddress) { decoders_.erase(deviceAddress); }
+    size_t size() const { return decoders_.size(); }
+
+private:
+    ManufacturerDataFormat format_;
+    std::map<DeviceAddress, DeltaDecoder> decoders_;
+};
+
+} // namespace BLEProfiles
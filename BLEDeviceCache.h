@@ -0,0 +1,249 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring> // for memcpy, memcmp
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+#include "BLECompanyDispatch.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Per-device decode state cache
+// Remembers, per BLE address, the resolved dispatch entry, the last
+// manufacturer data and its decoded values. A byte-identical repeat
+// advert returns the cached values without a lookup or decode.
+//
+// The address index is open-addressed (linear probing, load <= 0.5,
+// backward-shift deletion); entries live in a fixed pool linked into
+// an LRU list and the least recently seen device is evicted when full.
+// Not thread-safe: use one cache per decoder thread.
+// -------------------------------------------------------------
+inline constexpr size_t DEVICE_CACHE_MAX_PAYLOAD = 31;   // longer adverts are decoded but never short-circuited
+
+// 32-bit FNV-1a; only used to reject changed payloads before the byte compare
+inline uint32_t hashPayload(const uint8_t* data, size_t len) {
+    uint32_t h = 0x811C9DC5u;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= data[i];
+        h *= 0x01000193u;
+    }
+    return h;
+}
+
+struct DeviceDecodeResult {
+    const CompanyDispatchEntry* entry;   // nullptr for unknown company IDs or malformed data
+    const float* values;                 // entry->format.fieldCount() values, valid until the next decode()
+    size_t decoded;                      // fields decoded, as returned by CompiledFormat::decode
+    bool duplicate;                      // payload identical to the device's previous advert
+};
+
+struct DeviceCacheStats {
+    uint64_t duplicates;   // adverts served from the cache
+    uint64_t decodes;      // adverts decoded
+    uint64_t evictions;    // devices dropped to make room
+    uint64_t unknown;      // adverts with no compiled format
+};
+
+class DeviceStateCache {
+public:
+    // table must outlive the cache
+    DeviceStateCache(const CompanyDispatchTable& table, size_t capacity)
+        : table_(table), capacity_(capacity ? capacity : 1),
+          stride_(table.maxFieldCount()), size_(0), head_(NONE), tail_(NONE),
+          stats_{0, 0, 0, 0}
+    {
+        size_t buckets = 2;
+        while (buckets < capacity_ * 2) buckets <<= 1;
+        buckets_.resize(buckets);
+        mask_ = buckets - 1;
+        shift_ = 64;
+        for (size_t b = buckets; b > 1; b >>= 1) --shift_;
+        nodes_.resize(capacity_);
+        values_.resize(capacity_ * stride_);
+    }
+
+    DeviceStateCache(const DeviceStateCache&) = delete;
+    DeviceStateCache& operator=(const DeviceStateCache&) = delete;
+
+    // Decode manufacturer data (company ID prefix included) from address
+    DeviceDecodeResult decode(DeviceAddress address, const uint8_t* data, size_t len) {
+        if (!data || len < 2) return { nullptr, nullptr, 0, false };
+        uint16_t companyId = static_cast<uint16_t>(data[0] | (data[1] << 8));
+        bool cacheable = len <= DEVICE_CACHE_MAX_PAYLOAD;
+        uint32_t hash = cacheable ? hashPayload(data, len) : 0;
+
+        uint32_t n = lookup(address);
+        if (n != NONE) {
+            Node& node = nodes_[n];
+            touch(n);
+            if (cacheable && node.length == len && node.hash == hash &&
+                memcmp(node.payload, data, len) == 0) {
+                ++stats_.duplicates;
+                return { node.entry, valuesOf(n), node.decoded, true };
+            }
+        }
+
+        // Reuse the device's resolved entry while its company ID is unchanged
+        const CompanyDispatchEntry* entry =
+            (n != NONE && nodes_[n].entry && nodes_[n].entry->companyId == companyId)
+                ? nodes_[n].entry : table_.find(companyId);
+        if (!entry || entry->format.fields.empty()) {
+            ++stats_.unknown;
+            if (n != NONE) remove(n);
+            return { nullptr, nullptr, 0, false };
+        }
+
+        if (n == NONE) n = insert(address);
+        Node& node = nodes_[n];
+        node.entry = entry;
+        node.decoded = entry->format.decode(data, len, valuesOf(n));
+        node.hash = hash;
+        node.length = cacheable ? static_cast<uint8_t>(len) : 0;   // 0 never matches a valid advert
+        if (cacheable) memcpy(node.payload, data, len);
+        ++stats_.decodes;
+        return { entry, valuesOf(n), node.decoded, false };
+    }
+
+    // Forget a device, e.g. after it disconnected or changed its address
+    void erase(DeviceAddress address) {
+        uint32_t n = lookup(address);
+        if (n != NONE) remove(n);
+    }
+
+    bool contains(DeviceAddress address) const { return lookup(address) != NONE; }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    DeviceCacheStats stats() const { return stats_; }
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    // One cache line per device: 62 bytes of fields on 64-bit targets
+    struct alignas(64) Node {
+        DeviceAddress address;
+        const CompanyDispatchEntry* entry;
+        uint32_t hash;
+        uint32_t prev;
+        uint32_t next;
+        uint16_t decoded;
+        uint8_t length;
+        uint8_t payload[DEVICE_CACHE_MAX_PAYLOAD];
+    };
+    static_assert(sizeof(Node) <= 64, "Node must fit in one cache line");
+
+    struct Bucket {
+        DeviceAddress address;
+        uint32_t node;
+        Bucket() : address(0), node(NONE) {}
+    };
+
+    size_t home(DeviceAddress address) const {
+        return static_cast<size_t>((address * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    float* valuesOf(uint32_t n) { return values_.data() + static_cast<size_t>(n) * stride_; }
+
+    uint32_t lookup(DeviceAddress address) const {
+        for (size_t i = home(address);; i = (i + 1) & mask_) {
+            const Bucket& b = buckets_[i];
+            if (b.node == NONE) return NONE;
+            if (b.address == address) return b.node;
+        }
+    }
+
+    uint32_t insert(DeviceAddress address) {
+        if (size_ == capacity_) {
+            remove(tail_);
+            ++stats_.evictions;
+        }
+        // remove() keeps nodes dense, so the free node is always index size_
+        uint32_t n = static_cast<uint32_t>(size_++);
+
+        size_t i = home(address);
+        while (buckets_[i].node != NONE) i = (i + 1) & mask_;
+        buckets_[i].address = address;
+        buckets_[i].node = n;
+
+        Node& node = nodes_[n];
+        node.address = address;
+        node.entry = nullptr;
+        node.length = 0;
+        node.decoded = 0;
+        node.prev = NONE;
+        node.next = head_;
+        if (head_ != NONE) nodes_[head_].prev = n;
+        head_ = n;
+        if (tail_ == NONE) tail_ = n;
+        return n;
+    }
+
+    void touch(uint32_t n) {
+        if (head_ == n) return;
+        unlink(n);
+        Node& node = nodes_[n];
+        node.prev = NONE;
+        node.next = head_;
+        nodes_[head_].prev = n;
+        head_ = n;
+    }
+
+    void unlink(uint32_t n) {
+        Node& node = nodes_[n];
+        if (node.prev != NONE) nodes_[node.prev].next = node.next; else head_ = node.next;
+        if (node.next != NONE) nodes_[node.next].prev = node.prev; else tail_ = node.prev;
+    }
+
+    size_t bucketOf(uint32_t n) const {
+        size_t i = home(nodes_[n].address);
+        while (buckets_[i].node != n) i = (i + 1) & mask_;
+        return i;
+    }
+
+    // Drops node n and moves the last node into its place
+    void remove(uint32_t n) {
+        unlink(n);
+        eraseBucket(bucketOf(n));
+
+        uint32_t last = static_cast<uint32_t>(--size_);
+        if (n != last) {
+            buckets_[bucketOf(last)].node = n;
+            nodes_[n] = nodes_[last];
+            Node& moved = nodes_[n];
+            if (moved.prev != NONE) nodes_[moved.prev].next = n; else head_ = n;
+            if (moved.next != NONE) nodes_[moved.next].prev = n; else tail_ = n;
+            memcpy(valuesOf(n), valuesOf(last), stride_ * sizeof(float));
+        }
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    void eraseBucket(size_t hole) {
+        for (size_t i = (hole + 1) & mask_; buckets_[i].node != NONE; i = (i + 1) & mask_) {
+            size_t h = home(buckets_[i].address);
+            // Move i into the hole unless its home lies cyclically in (hole, i]
+            bool stays = (hole <= i) ? (hole < h && h <= i) : (hole < h || h <= i);
+            if (stays) continue;
+            buckets_[hole] = buckets_[i];
+            hole = i;
+        }
+        buckets_[hole] = Bucket();
+    }
+
+    const CompanyDispatchTable& table_;
+    size_t capacity_;
+    size_t stride_;
+    size_t size_;
+    size_t mask_;
+    unsigned shift_;
+    uint32_t head_;   // most recently seen
+    uint32_t tail_;   // eviction candidate
+    std::vector<Bucket> buckets_;
+    std::vector<Node> nodes_;
+    std::vector<float> values_;
+    DeviceCacheStats stats_;
+};
+
+} // namespace BLEProfiles
@@ -2,8 +2,26 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <deque>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <cstdint>
 #include <cstring> // for memcpy
+#if defined(_MSC_VER)
+#include <stdlib.h> // for _byteswap_*
+#endif
+
+#if __has_include(<span>) && __cplusplus >= 202002L
+#include <span>
+#endif
+#include "BLECounters.h"
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#include <string_view>
+#endif
 
 namespace BLEProfiles {
 
@@ -28,7 +46,19 @@ enum class DataType {
     UINT16_LE, UINT16_BE,
     INT16_LE,  INT16_BE,
     UINT32_LE, UINT32_BE,
-    FLOAT_LE,  FLOAT_BE
+    FLOAT_LE,  FLOAT_BE,
+    UINT_BITS, INT_BITS     // sub-byte fields, see DataFieldConfig::bitOffset / bitWidth
+};
+
+// -------------------------------------------------------------
+// Field wire encoding
+// DELTA_VARINT fields are sent as zigzag-varint deltas against the last
+// keyframe by DeltaEncoder (BLEDeltaCodec.h); the stateless pack/parse
+// functions here always use the absolute layout.
+// -------------------------------------------------------------
+enum class FieldEncoding : uint8_t {
+    ABSOLUTE,
+    DELTA_VARINT
 };
 
 // -------------------------------------------------------------
@@ -68,25 +98,85 @@ inline const std::map<std::string, BLEProfiles::SensorGroup> PROFILE_NAME_TO_GRO
     { "CurrentSensor",       BLEProfiles::SensorGroup::CURRENT }
 };
 
+// -------------------------------------------------------------
+// Interned sensor names
+// Every distinct sensor name gets a small process-wide ID the first
+// time a DataFieldConfig uses it. Hot paths compare IDs; names are
+// resolved only at the edges (export, logging).
+// -------------------------------------------------------------
+using SensorNameId = uint16_t;
+inline constexpr SensorNameId INVALID_SENSOR_NAME_ID = 0xFFFF;
+
+struct SensorNameTable {
+    std::mutex mutex;
+    std::deque<std::string> names;              // indexed by ID, references stay valid
+    std::map<std::string, SensorNameId> ids;
+};
+
+inline SensorNameTable& sensorNameTable() {
+    static SensorNameTable table;
+    return table;
+}
+
+inline SensorNameId internSensorName(const std::string& name) {
+    SensorNameTable& t = sensorNameTable();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    auto it = t.ids.find(name);
+    if (it != t.ids.end()) return it->second;
+    if (t.names.size() >= INVALID_SENSOR_NAME_ID) return INVALID_SENSOR_NAME_ID;
+    SensorNameId id = static_cast<SensorNameId>(t.names.size());
+    t.names.push_back(name);
+    t.ids.emplace(name, id);
+    return id;
+}
+
+// Returns INVALID_SENSOR_NAME_ID for names no profile has used
+inline SensorNameId findSensorNameId(const std::string& name) {
+    SensorNameTable& t = sensorNameTable();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    auto it = t.ids.find(name);
+    return it != t.ids.end() ? it->second : INVALID_SENSOR_NAME_ID;
+}
+
+inline const std::string& getSensorNameForId(SensorNameId id) {
+    static const std::string empty;
+    SensorNameTable& t = sensorNameTable();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    return id < t.names.size() ? t.names[id] : empty;
+}
+
 // -------------------------------------------------------------
 // Data structures
 // -------------------------------------------------------------
 struct DataFieldConfig {
     std::string sensorName;
-    uint8_t offset;
+    uint16_t offset;       // from the start of the payload (after the company ID)
     DataType dataType;
     float scale;
     std::string unit;
+    SensorNameId nameId;   // interned sensorName; re-intern if sensorName is changed later
+    uint8_t bitOffset;     // UINT_BITS / INT_BITS only: first bit (0-7, LSB first) at offset
+    uint8_t bitWidth;      // UINT_BITS / INT_BITS only: width in bits (1-32)
+    FieldEncoding encoding;
 
-    DataFieldConfig(const std::string& name, uint8_t off, DataType type,
+    DataFieldConfig(const std::string& name, uint16_t off, DataType type,
                     float sc = 1.0f, const std::string& u = "")
-        : sensorName(name), offset(off), dataType(type), scale(sc), unit(u) {}
+        : sensorName(name), offset(off), dataType(type), scale(sc), unit(u),
+          nameId(internSensorName(name)), bitOffset(0), bitWidth(0),
+          encoding(FieldEncoding::ABSOLUTE) {}
+
+    // Bit field: width bits starting at bit bitOff of byte off
+    DataFieldConfig(const std::string& name, uint16_t off, uint8_t bitOff, uint8_t width,
+                    DataType type, float sc = 1.0f, const std::string& u = "")
+        : sensorName(name), offset(off), dataType(type), scale(sc), unit(u),
+          nameId(internSensorName(name)), bitOffset(bitOff), bitWidth(width),
+          encoding(FieldEncoding::ABSOLUTE) {}
 };
 
 struct ManufacturerDataFormat {
     uint16_t companyId;
     std::vector<DataFieldConfig> dataFields;
-    uint8_t totalLength;
+    uint16_t totalLength;      // payload bytes after the company ID; see BLEFragmentAssembly.h for payloads split over several packets
     std::string description;
 
     ManufacturerDataFormat() : companyId(0), totalLength(0), description("") {}
@@ -101,20 +191,177 @@ struct DeviceProfile {
 };
 
 // -------------------------------------------------------------
-// Profile creation helper
+// Compile-time profile definitions
+// A definition struct provides profileName, deviceName, description,
+// companyId, totalLength and a constexpr StaticField fields[] table.
+// BLEStaticProfile.h generates straight-line codecs from the same struct.
 // -------------------------------------------------------------
-inline DeviceProfile createEnvironmentalProfile() {
-    ManufacturerDataFormat mfg(COMPANY_ID_ENVIRONMENTAL, "Environmental Manufacturer Data");
-    mfg.dataFields = {
-        {"Temperature", 0, DataType::INT16_LE, 0.01f, "°C"},
-        {"Humidity",    2, DataType::UINT16_LE, 0.01f, "%"},
+struct StaticField {
+    const char* sensorName;
+    uint16_t offset;
+    DataType dataType;
+    float scale;
+    const char* unit;
+    uint8_t bitOffset = 0;   // UINT_BITS / INT_BITS only
+    uint8_t bitWidth  = 0;
+    FieldEncoding encoding = FieldEncoding::ABSOLUTE;
+};
+
+struct EnvironmentalProfileDef {
+    static constexpr const char* profileName = "EnvironmentalSensor";
+    static constexpr const char* deviceName  = "EnviroSensor-X";
+    static constexpr const char* description = "Environmental Manufacturer Data";
+    static constexpr uint16_t companyId      = COMPANY_ID_ENVIRONMENTAL;
+    static constexpr uint16_t totalLength    = 9;
+    static constexpr StaticField fields[] = {
+        {"Temperature", 0, DataType::INT16_LE,  0.01f,  "°C"},
+        {"Humidity",    2, DataType::UINT16_LE, 0.01f,  "%"},
         {"Pressure",    4, DataType::UINT32_LE, 0.001f, "hPa"},
-        {"Battery",     8, DataType::UINT8,     1.0f, "%"}
+        {"Battery",     8, DataType::UINT8,     1.0f,   "%"}
     };
-    mfg.totalLength = 9;
-    return { "EnvironmentalSensor", "EnviroSensor-X", mfg };
+};
+
+struct AirQualityProfileDef {
+    static constexpr const char* profileName = "AirQualitySensor";
+    static constexpr const char* deviceName  = "AirSensor-X";
+    static constexpr const char* description = "Air Quality Manufacturer Data";
+    static constexpr uint16_t companyId      = COMPANY_ID_AIR_QUALITY;
+    static constexpr uint16_t totalLength    = 9;
+    static constexpr StaticField fields[] = {
+        {"CO2",     0, DataType::UINT16_LE, 1.0f, "ppm"},
+        {"TVOC",    2, DataType::UINT16_LE, 1.0f, "ppb"},
+        {"PM2.5",   4, DataType::UINT16_LE, 0.1f, "µg/m³"},
+        {"PM10",    6, DataType::UINT16_LE, 0.1f, "µg/m³"},
+        {"Battery", 8, DataType::UINT8,     1.0f, "%"}
+    };
+};
+
+struct MotionProfileDef {
+    static constexpr const char* profileName = "MotionSensor";
+    static constexpr const char* deviceName  = "MotionSensor-X";
+    static constexpr const char* description = "Motion Manufacturer Data";
+    static constexpr uint16_t companyId      = COMPANY_ID_MOTION;
+    static constexpr uint16_t totalLength    = 13;
+    static constexpr StaticField fields[] = {
+        {"AccelX",   0, DataType::INT16_LE, 0.001f, "g"},
+        {"AccelY",   2, DataType::INT16_LE, 0.001f, "g"},
+        {"AccelZ",   4, DataType::INT16_LE, 0.001f, "g"},
+        {"GyroX",    6, DataType::INT16_LE, 0.1f,   "°/s"},
+        {"GyroY",    8, DataType::INT16_LE, 0.1f,   "°/s"},
+        {"GyroZ",   10, DataType::INT16_LE, 0.1f,   "°/s"},
+        {"Battery", 12, DataType::UINT8,    1.0f,   "%"}
+    };
+};
+
+struct AmbientProfileDef {
+    static constexpr const char* profileName = "AmbientSensor";
+    static constexpr const char* deviceName  = "AmbientSensor-X";
+    static constexpr const char* description = "Ambient Manufacturer Data";
+    static constexpr uint16_t companyId      = COMPANY_ID_AMBIENT;
+    static constexpr uint16_t totalLength    = 8;
+    static constexpr StaticField fields[] = {
+        {"Illuminance", 0, DataType::UINT32_LE, 0.01f, "lx"},
+        {"UVIndex",     4, DataType::UINT8,     0.1f,  ""},
+        {"Noise",       5, DataType::UINT16_LE, 0.1f,  "dB"},
+        {"Battery",     7, DataType::UINT8,     1.0f,  "%"}
+    };
+};
+
+struct SystemProfileDef {
+    static constexpr const char* profileName = "SystemSensor";
+    static constexpr const char* deviceName  = "SystemMonitor-X";
+    static constexpr const char* description = "System Manufacturer Data";
+    static constexpr uint16_t companyId      = COMPANY_ID_SYSTEM;
+    static constexpr uint16_t totalLength    = 13;
+    static constexpr StaticField fields[] = {
+        {"Uptime",           0, DataType::UINT32_LE, 1.0f,  "s"},
+        {"FreeHeap",         4, DataType::UINT32_LE, 1.0f,  "B"},
+        {"ChipTemperature",  8, DataType::INT16_LE,  0.01f, "°C"},
+        {"CPULoad",         10, DataType::UINT8,     1.0f,  "%"},
+        {"RSSI",            11, DataType::INT8,      1.0f,  "dBm"},
+        {"Battery",         12, DataType::UINT8,     1.0f,  "%"}
+    };
+};
+
+struct CurrentProfileDef {
+    static constexpr const char* profileName = "CurrentSensor";
+    static constexpr const char* deviceName  = "CurrentSensor-X";
+    static constexpr const char* description = "Current Manufacturer Data";
+    static constexpr uint16_t companyId      = COMPANY_ID_CURRENT;
+    static constexpr uint16_t totalLength    = 13;
+    static constexpr StaticField fields[] = {
+        {"Current",  0, DataType::INT16_LE,  0.001f, "A"},
+        {"Voltage",  2, DataType::UINT16_LE, 0.001f, "V"},
+        {"Power",    4, DataType::UINT32_LE, 0.001f, "W"},
+        {"Energy",   8, DataType::UINT32_LE, 0.001f, "kWh"},
+        {"Battery", 12, DataType::UINT8,     1.0f,   "%"}
+    };
+};
+
+// Uniform, constexpr view of a definition struct; lives in rodata
+struct StaticProfileInfo {
+    const char* profileName;
+    const char* deviceName;
+    const char* description;
+    uint16_t companyId;
+    uint16_t totalLength;
+    const StaticField* fields;
+    size_t fieldCount;
+};
+
+template <typename Def>
+constexpr StaticProfileInfo staticProfileInfo() {
+    return { Def::profileName, Def::deviceName, Def::description, Def::companyId, Def::totalLength,
+             Def::fields, sizeof(Def::fields) / sizeof(Def::fields[0]) };
+}
+
+inline DeviceProfile makeDeviceProfile(const StaticProfileInfo& info) {
+    ManufacturerDataFormat mfg(info.companyId, info.description);
+    mfg.dataFields.reserve(info.fieldCount);
+    for (size_t i = 0; i < info.fieldCount; ++i) {
+        const StaticField& f = info.fields[i];
+        mfg.dataFields.emplace_back(f.sensorName, f.offset, f.bitOffset, f.bitWidth,
+                                    f.dataType, f.scale, f.unit);
+        mfg.dataFields.back().encoding = f.encoding;
+    }
+    mfg.totalLength = info.totalLength;
+    return { info.profileName, info.deviceName, mfg };
+}
+
+template <typename Def>
+inline DeviceProfile makeDeviceProfile() {
+    return makeDeviceProfile(staticProfileInfo<Def>());
 }
 
+// Compile-time list of profile definitions; getAllProfiles() expands BuiltinProfiles
+template <typename... Defs>
+struct ProfileList {
+    static constexpr size_t size = sizeof...(Defs);
+    static constexpr StaticProfileInfo table[] = { staticProfileInfo<Defs>()... };
+
+    static std::vector<DeviceProfile> deviceProfiles() {
+        return { makeDeviceProfile<Defs>()... };
+    }
+};
+
+using BuiltinProfiles = ProfileList<
+    EnvironmentalProfileDef,
+    AirQualityProfileDef,
+    MotionProfileDef,
+    AmbientProfileDef,
+    SystemProfileDef,
+    CurrentProfileDef>;
+
+// -------------------------------------------------------------
+// Profile creation helpers
+// -------------------------------------------------------------
+inline DeviceProfile createEnvironmentalProfile() { return makeDeviceProfile<EnvironmentalProfileDef>(); }
+inline DeviceProfile createAirQualityProfile()    { return makeDeviceProfile<AirQualityProfileDef>(); }
+inline DeviceProfile createMotionProfile()        { return makeDeviceProfile<MotionProfileDef>(); }
+inline DeviceProfile createAmbientProfile()       { return makeDeviceProfile<AmbientProfileDef>(); }
+inline DeviceProfile createSystemProfile()        { return makeDeviceProfile<SystemProfileDef>(); }
+inline DeviceProfile createCurrentProfile()       { return makeDeviceProfile<CurrentProfileDef>(); }
+
 // -------------------------------------------------------------
 // Utility to get size of DataType in bytes
 // -------------------------------------------------------------
@@ -130,69 +377,369 @@ inline size_t dataTypeSize(DataType dt) {
         case DataType::UINT32_BE:
         case DataType::FLOAT_LE:
         case DataType::FLOAT_BE: return 4;
+        case DataType::UINT_BITS:
+        case DataType::INT_BITS: return 0; // depends on the field, see fieldByteSize()
     }
     return 0;
 }
 
+constexpr bool isBitFieldType(DataType dt) {
+    return dt == DataType::UINT_BITS || dt == DataType::INT_BITS;
+}
+
+// Memory-safety guard for the bit helpers: a layout validateFormat()
+// rejects (bitOffset > 7, bitWidth 0 or > 32) is read as if clamped to
+// 0-7 / 1-32, so it never shifts past 64 bits or touches more than 5 bytes.
+// Fields keep the layout they were given, so validation still sees it.
+constexpr uint8_t clampBitOffset(uint8_t bitOffset) { return bitOffset > 7 ? 7 : bitOffset; }
+constexpr uint8_t clampBitWidth(uint8_t bitWidth) { return bitWidth == 0 ? 1 : bitWidth > 32 ? 32 : bitWidth; }
+
+// Bytes touched by a bit field starting at bitOffset within its first byte
+constexpr size_t bitFieldByteSpan(uint8_t bitOffset, uint8_t bitWidth) {
+    return (static_cast<size_t>(clampBitOffset(bitOffset)) + clampBitWidth(bitWidth) + 7) / 8;
+}
+
+constexpr uint32_t bitMaskFor(uint8_t bitWidth) {
+    return bitWidth >= 32 ? 0xFFFFFFFFu : ((1u << bitWidth) - 1u);
+}
+
+// Bytes a field occupies starting at field.offset
+inline size_t fieldByteSize(const DataFieldConfig& field) {
+    return isBitFieldType(field.dataType) ? bitFieldByteSpan(field.bitOffset, field.bitWidth)
+                                          : dataTypeSize(field.dataType);
+}
+
+// -------------------------------------------------------------
+// Byte order helpers (unaligned loads/stores, compiler bswap intrinsics)
+// -------------------------------------------------------------
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+inline constexpr bool HOST_IS_BIG_ENDIAN = true;
+#else
+inline constexpr bool HOST_IS_BIG_ENDIAN = false;
+#endif
+
+inline uint16_t byteSwap16(uint16_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap16(v);
+#elif defined(_MSC_VER)
+    return _byteswap_ushort(v);
+#else
+    return static_cast<uint16_t>((v >> 8) | (v << 8));
+#endif
+}
+
+inline uint32_t byteSwap32(uint32_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(v);
+#elif defined(_MSC_VER)
+    return _byteswap_ulong(v);
+#else
+    return (v >> 24) | ((v >> 8) & 0x0000FF00u) | ((v << 8) & 0x00FF0000u) | (v << 24);
+#endif
+}
+
+inline uint16_t loadUInt16(const uint8_t* p, bool bigEndian) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return (bigEndian != HOST_IS_BIG_ENDIAN) ? byteSwap16(v) : v;
+}
+
+inline uint32_t loadUInt32(const uint8_t* p, bool bigEndian) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return (bigEndian != HOST_IS_BIG_ENDIAN) ? byteSwap32(v) : v;
+}
+
+inline void storeUInt16(uint8_t* p, uint16_t v, bool bigEndian) {
+    if (bigEndian != HOST_IS_BIG_ENDIAN) v = byteSwap16(v);
+    memcpy(p, &v, sizeof(v));
+}
+
+inline void storeUInt32(uint8_t* p, uint32_t v, bool bigEndian) {
+    if (bigEndian != HOST_IS_BIG_ENDIAN) v = byteSwap32(v);
+    memcpy(p, &v, sizeof(v));
+}
+
+inline float loadFloat(const uint8_t* p, bool bigEndian) {
+    uint32_t bits = loadUInt32(p, bigEndian);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+inline void storeFloat(uint8_t* p, float v, bool bigEndian) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    storeUInt32(p, bits, bigEndian);
+}
+
+// Bit fields: bits [bitOffset, bitOffset + bitWidth) counted LSB first from p[0]
+inline uint32_t loadBits(const uint8_t* p, uint8_t bitOffset, uint8_t bitWidth) {
+    bitOffset = clampBitOffset(bitOffset);
+    bitWidth = clampBitWidth(bitWidth);
+    size_t span = bitFieldByteSpan(bitOffset, bitWidth);
+    uint64_t v = 0;
+    for (size_t i = 0; i < span; ++i) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return static_cast<uint32_t>(v >> bitOffset) & bitMaskFor(bitWidth);
+}
+
+// Read-modify-write; bits outside the field are preserved
+inline void storeBits(uint8_t* p, uint8_t bitOffset, uint8_t bitWidth, uint32_t value) {
+    bitOffset = clampBitOffset(bitOffset);
+    bitWidth = clampBitWidth(bitWidth);
+    size_t span = bitFieldByteSpan(bitOffset, bitWidth);
+    uint64_t mask = static_cast<uint64_t>(bitMaskFor(bitWidth)) << bitOffset;
+    uint64_t bits = (static_cast<uint64_t>(value) << bitOffset) & mask;
+    for (size_t i = 0; i < span; ++i) {
+        uint8_t m = static_cast<uint8_t>(mask >> (8 * i));
+        p[i] = static_cast<uint8_t>((p[i] & ~m) | (static_cast<uint8_t>(bits >> (8 * i)) & m));
+    }
+}
+
+inline float bitsToFloat(uint32_t raw, uint8_t bitWidth, bool isSigned) {
+    if (!isSigned) return static_cast<float>(raw);
+    uint32_t sign = 1u << (clampBitWidth(bitWidth) - 1);
+    return static_cast<float>(static_cast<int32_t>((raw ^ sign) - sign));
+}
+
+inline bool isFloatType(DataType dt) {
+    return dt == DataType::FLOAT_LE || dt == DataType::FLOAT_BE;
+}
+
+// Integer stored for field in the absolute layout; FLOAT fields return their bit pattern
+inline int64_t loadFieldRaw(const uint8_t* payload, const DataFieldConfig& field) {
+    const uint8_t* p = payload + field.offset;
+    switch (field.dataType) {
+        case DataType::UINT8:     return p[0];
+        case DataType::INT8:      return static_cast<int8_t>(p[0]);
+        case DataType::UINT16_LE: return loadUInt16(p, false);
+        case DataType::UINT16_BE: return loadUInt16(p, true);
+        case DataType::INT16_LE:  return static_cast<int16_t>(loadUInt16(p, false));
+        case DataType::INT16_BE:  return static_cast<int16_t>(loadUInt16(p, true));
+        case DataType::UINT32_LE:
+        case DataType::FLOAT_LE:  return loadUInt32(p, false);
+        case DataType::UINT32_BE:
+        case DataType::FLOAT_BE:  return loadUInt32(p, true);
+        case DataType::UINT_BITS: return loadBits(p, field.bitOffset, field.bitWidth);
+        case DataType::INT_BITS: {
+            uint32_t raw = loadBits(p, field.bitOffset, field.bitWidth);
+            uint32_t sign = 1u << (clampBitWidth(field.bitWidth) - 1);
+            return static_cast<int32_t>((raw ^ sign) - sign);
+        }
+    }
+    return 0;
+}
+
+// Inverse of loadFieldRaw; out-of-range values wrap to the field width
+inline void storeFieldRaw(uint8_t* payload, const DataFieldConfig& field, int64_t raw) {
+    uint8_t* p = payload + field.offset;
+    uint32_t v = static_cast<uint32_t>(raw);
+    switch (field.dataType) {
+        case DataType::UINT8:
+        case DataType::INT8:      p[0] = static_cast<uint8_t>(v); break;
+        case DataType::UINT16_LE:
+        case DataType::INT16_LE:  storeUInt16(p, static_cast<uint16_t>(v), false); break;
+        case DataType::UINT16_BE:
+        case DataType::INT16_BE:  storeUInt16(p, static_cast<uint16_t>(v), true); break;
+        case DataType::UINT32_LE:
+        case DataType::FLOAT_LE:  storeUInt32(p, v, false); break;
+        case DataType::UINT32_BE:
+        case DataType::FLOAT_BE:  storeUInt32(p, v, true); break;
+        case DataType::UINT_BITS:
+        case DataType::INT_BITS:  storeBits(p, field.bitOffset, field.bitWidth, v); break;
+    }
+}
+
+// -------------------------------------------------------------
+// Saturating float -> raw integer conversion
+// Values round to nearest (ties away from zero) and clamp to what the
+// field can hold; NaN gives range.lo. Written as min/max, converts and
+// adds with no data-dependent branches, so per-sample loops vectorize
+// (GCC needs -fno-trapping-math for that). saturateRaw() makes no libm
+// calls, which matters on soft-float targets.
+// -------------------------------------------------------------
+struct RawRange {
+    float lo;
+    float hi;
+};
+
+// Largest float not above m (float(m) rounds up for wide m)
+inline float floatAtMost(uint32_t m) {
+    float f = static_cast<float>(m);
+    return static_cast<double>(f) > m ? std::nextafter(f, 0.0f) : f;
+}
+
+// Raw range of a data type; bitWidth is used by UINT_BITS / INT_BITS only.
+// FLOAT types are unbounded.
+inline RawRange rawRangeFor(DataType dataType, uint8_t bitWidth = 0) {
+    switch (dataType) {
+        case DataType::UINT8:     return { 0.0f, 255.0f };
+        case DataType::INT8:      return { -128.0f, 127.0f };
+        case DataType::UINT16_LE:
+        case DataType::UINT16_BE: return { 0.0f, 65535.0f };
+        case DataType::INT16_LE:
+        case DataType::INT16_BE:  return { -32768.0f, 32767.0f };
+        case DataType::UINT32_LE:
+        case DataType::UINT32_BE: return { 0.0f, floatAtMost(0xFFFFFFFFu) };
+        case DataType::UINT_BITS: return { 0.0f, floatAtMost(bitMaskFor(clampBitWidth(bitWidth))) };
+        case DataType::INT_BITS: {
+            uint32_t sign = 1u << (clampBitWidth(bitWidth) - 1);
+            return { -static_cast<float>(sign), floatAtMost(sign - 1) };
+        }
+        case DataType::FLOAT_LE:
+        case DataType::FLOAT_BE:  break;
+    }
+    return { -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() };
+}
+
+// range must be finite (not a FLOAT type's) and fit Int: int32_t covers
+// every type except 32-bit unsigned fields and vectorizes better than int64_t
+template <typename Int = int64_t>
+inline Int saturateRaw(float val, RawRange range) {
+    float c = std::min(std::max(range.lo, val), range.hi);   // argument order sends NaN to lo
+    Int i = static_cast<Int>(c);
+    float frac = c - static_cast<float>(i);                   // exact, in (-1, 1)
+    return i + static_cast<Int>(frac + frac);                 // +-1 when |frac| >= 0.5
+}
+
+// Raw bits of a bit field of bitWidth bits
+inline uint32_t floatToBits(float val, uint8_t bitWidth, bool isSigned) {
+    RawRange range = rawRangeFor(isSigned ? DataType::INT_BITS : DataType::UINT_BITS, bitWidth);
+    return static_cast<uint32_t>(saturateRaw(val, range)) & bitMaskFor(clampBitWidth(bitWidth));
+}
+
 // -------------------------------------------------------------
 // Manufacturer data packing helpers
 // -------------------------------------------------------------
-inline std::vector<uint8_t> packManufacturerData(
-    const std::map<std::string, float>& sensorValues,
-    const ManufacturerDataFormat& format)
-{
-    std::vector<uint8_t> data(2 + format.totalLength, 0);
+
+// Encode one value (already divided by the field scale) at dst;
+// integer types saturate, see saturateRaw()
+inline void packField(uint8_t* dst, DataType dataType, float val) {
+    switch (dataType) {
+        case DataType::UINT8:
+        case DataType::INT8:
+            dst[0] = static_cast<uint8_t>(saturateRaw<int32_t>(val, rawRangeFor(dataType)));
+            break;
+        case DataType::UINT16_LE:
+        case DataType::UINT16_BE:
+        case DataType::INT16_LE:
+        case DataType::INT16_BE:
+            storeUInt16(dst, static_cast<uint16_t>(saturateRaw<int32_t>(val, rawRangeFor(dataType))),
+                        dataType == DataType::UINT16_BE || dataType == DataType::INT16_BE);
+            break;
+        case DataType::UINT32_LE:
+        case DataType::UINT32_BE:
+            storeUInt32(dst, static_cast<uint32_t>(saturateRaw(val, rawRangeFor(dataType))),
+                        dataType == DataType::UINT32_BE);
+            break;
+        case DataType::FLOAT_LE:
+        case DataType::FLOAT_BE:
+            storeFloat(dst, val, dataType == DataType::FLOAT_BE);
+            break;
+        case DataType::UINT_BITS:
+        case DataType::INT_BITS:
+            break; // needs the field's bit layout, see packFieldValue()
+        default:
+            BLE_COUNT(UNSUPPORTED_DATA_TYPES, 1);
+            break;
+    }
+}
+
+// Encode one field into payload (the bytes after the company ID)
+inline void packFieldValue(uint8_t* payload, const DataFieldConfig& field, float val) {
+    if (isBitFieldType(field.dataType)) {
+        storeBits(payload + field.offset, field.bitOffset, field.bitWidth,
+                  floatToBits(val, field.bitWidth, field.dataType == DataType::INT_BITS));
+        return;
+    }
+    packField(payload + field.offset, field.dataType, val);
+}
+
+// Packs every field for which find(field) returns a value into data
+// (2 + totalLength zeroed bytes); shared by the map-based overloads
+template <typename FindValue>
+inline void packFoundFields(uint8_t* data, const ManufacturerDataFormat& format, FindValue find) {
+    BLE_COUNT_CYCLES(PACK_CALLS, PACK_CYCLES);
+    BLE_COUNT(PACKETS_PACKED, 1);
 
     // First two bytes: company ID (little endian)
     data[0] = static_cast<uint8_t>(format.companyId & 0xFF);
     data[1] = static_cast<uint8_t>((format.companyId >> 8) & 0xFF);
 
     for (const auto& field : format.dataFields) {
-        auto it = sensorValues.find(field.sensorName);
-        if (it == sensorValues.end()) continue;
-
-        float val = it->second / (field.scale != 0.0f ? field.scale : 1.0f);
-
-        switch (field.dataType) {
-            case DataType::UINT8:
-                data[2 + field.offset] = static_cast<uint8_t>(val);
-                break;
-            case DataType::INT8:
-                data[2 + field.offset] = static_cast<int8_t>(val);
-                break;
-            case DataType::UINT16_LE: {
-                uint16_t v = static_cast<uint16_t>(val);
-                data[2 + field.offset]     = v & 0xFF;
-                data[2 + field.offset + 1] = (v >> 8) & 0xFF;
-                break;
-            }
-            case DataType::INT16_LE: {
-                int16_t v = static_cast<int16_t>(val);
-                data[2 + field.offset]     = v & 0xFF;
-                data[2 + field.offset + 1] = (v >> 8) & 0xFF;
-                break;
-            }
-            case DataType::UINT32_LE: {
-                uint32_t v = static_cast<uint32_t>(val);
-                data[2 + field.offset]     = v & 0xFF;
-                data[2 + field.offset + 1] = (v >> 8) & 0xFF;
-                data[2 + field.offset + 2] = (v >> 16) & 0xFF;
-                data[2 + field.offset + 3] = (v >> 24) & 0xFF;
-                break;
-            }
-            case DataType::FLOAT_LE: {
-                float fval = val;
-                memcpy(&data[2 + field.offset], &fval, sizeof(float));
-                break;
-            }
-            default:
-                break; // unsupported type
+        const float* value = find(field);
+        if (!value) continue;
+        if (field.offset + fieldByteSize(field) > format.totalLength) {
+            BLE_COUNT(FIELDS_OUT_OF_BOUNDS, 1);
+            continue;
         }
+
+        // Multiply by the reciprocal so results match CompiledFormat::encode()
+        float val = *value * (1.0f / (field.scale != 0.0f ? field.scale : 1.0f));
+        packFieldValue(&data[2], field, val);
     }
+}
 
+inline std::vector<uint8_t> packManufacturerData(
+    const std::map<std::string, float>& sensorValues,
+    const ManufacturerDataFormat& format)
+{
+    std::vector<uint8_t> data(2 + format.totalLength, 0);
+    packFoundFields(data.data(), format, [&](const DataFieldConfig& field) -> const float* {
+        auto it = sensorValues.find(field.sensorName);
+        return it != sensorValues.end() ? &it->second : nullptr;
+    });
     return data;
 }
 
+// -------------------------------------------------------------
+// In-place packing: values[i] belongs to format.dataFields[i]; a NaN
+// value leaves its field zero-filled like a missing map entry.
+// Writes 2 + totalLength bytes into out and returns that count, or 0
+// when capacity is too small. Allocates nothing.
+// -------------------------------------------------------------
+inline size_t packManufacturerData(
+    const float* values,
+    size_t valueCount,
+    const ManufacturerDataFormat& format,
+    uint8_t* out,
+    size_t capacity)
+{
+    BLE_COUNT_CYCLES(PACK_CALLS, PACK_CYCLES);
+    size_t len = 2 + static_cast<size_t>(format.totalLength);
+    if (!out || capacity < len) return 0;
+    BLE_COUNT(PACKETS_PACKED, 1);
+
+    memset(out, 0, len);
+    out[0] = static_cast<uint8_t>(format.companyId & 0xFF);
+    out[1] = static_cast<uint8_t>((format.companyId >> 8) & 0xFF);
+
+    size_t n = format.dataFields.size() < valueCount ? format.dataFields.size() : valueCount;
+    for (size_t i = 0; i < n; ++i) {
+        const DataFieldConfig& field = format.dataFields[i];
+        if (values[i] != values[i]) continue; // NaN: no value for this field
+        if (field.offset + fieldByteSize(field) > format.totalLength) {
+            BLE_COUNT(FIELDS_OUT_OF_BOUNDS, 1);
+            continue;
+        }
+
+        float val = values[i] * (1.0f / (field.scale != 0.0f ? field.scale : 1.0f));
+        packFieldValue(out + 2, field, val);
+    }
+
+    return len;
+}
+
+#if defined(__cpp_lib_span)
+inline size_t packManufacturerData(
+    std::span<const float> values,
+    const ManufacturerDataFormat& format,
+    std::span<uint8_t> out)
+{
+    return packManufacturerData(values.data(), values.size(), format, out.data(), out.size());
+}
+#endif
+
 // -------------------------------------------------------------
 // Pack data for a sensor group using the associated device profile
 // -------------------------------------------------------------
@@ -204,60 +751,230 @@ inline std::vector<uint8_t> packSensorGroupData(
     return packManufacturerData(sensorValues, profile.manufacturerFormat);
 }
 
+inline size_t packSensorGroupData(
+    const float* values,
+    size_t valueCount,
+    SensorGroup /*group*/,
+    const DeviceProfile& profile,
+    uint8_t* out,
+    size_t capacity)
+{
+    return packManufacturerData(values, valueCount, profile.manufacturerFormat, out, capacity);
+}
+
 // -------------------------------------------------------------
 // Parse manufacturer data (handles company ID prefix)
 // -------------------------------------------------------------
+
+// Decode one raw (unscaled) value at src
+inline float parseField(const uint8_t* src, DataType dataType) {
+    switch (dataType) {
+        case DataType::UINT8:     return static_cast<float>(src[0]);
+        case DataType::INT8:      return static_cast<float>(static_cast<int8_t>(src[0]));
+        case DataType::UINT16_LE: return static_cast<float>(loadUInt16(src, false));
+        case DataType::UINT16_BE: return static_cast<float>(loadUInt16(src, true));
+        case DataType::INT16_LE:  return static_cast<float>(static_cast<int16_t>(loadUInt16(src, false)));
+        case DataType::INT16_BE:  return static_cast<float>(static_cast<int16_t>(loadUInt16(src, true)));
+        case DataType::UINT32_LE: return static_cast<float>(loadUInt32(src, false));
+        case DataType::UINT32_BE: return static_cast<float>(loadUInt32(src, true));
+        case DataType::FLOAT_LE:  return loadFloat(src, false);
+        case DataType::FLOAT_BE:  return loadFloat(src, true);
+        case DataType::UINT_BITS:
+        case DataType::INT_BITS:  break; // needs the field's bit layout, see parseFieldValue()
+        default:                  BLE_COUNT(UNSUPPORTED_DATA_TYPES, 1); break;
+    }
+    return 0.0f;
+}
+
+// Decode one raw (unscaled) field from payload (the bytes after the company ID)
+inline float parseFieldValue(const uint8_t* payload, const DataFieldConfig& field) {
+    if (isBitFieldType(field.dataType)) {
+        return bitsToFloat(loadBits(payload + field.offset, field.bitOffset, field.bitWidth),
+                           field.bitWidth, field.dataType == DataType::INT_BITS);
+    }
+    return parseField(payload + field.offset, field.dataType);
+}
+
+// Calls store(field, value) for every field that fits in data; shared by
+// the map-based overloads
+template <typename StoreValue>
+inline void parseFittingFields(const uint8_t* data, size_t len, const ManufacturerDataFormat& format,
+                               StoreValue store) {
+    BLE_COUNT_CYCLES(PARSE_CALLS, PARSE_CYCLES);
+    if (!data || len < 2) return;
+    BLE_COUNT_PACKETS(data[0] | (data[1] << 8), 1);
+
+    // Skip first two bytes (company ID)
+    const uint8_t* payload = data + 2;
+    size_t payloadLen = len - 2;
+
+    for (const auto& field : format.dataFields) {
+        size_t fieldLen = fieldByteSize(field);
+        if (field.offset + fieldLen > payloadLen) {
+            BLE_COUNT(FIELDS_OUT_OF_BOUNDS, 1);
+            continue;
+        }
+
+        float parsedValue = parseFieldValue(payload, field);
+
+        if (field.scale != 0.0f) parsedValue *= field.scale;
+        store(field, parsedValue);
+    }
+}
+
 inline std::map<std::string,float> parseManufacturerData(
     const uint8_t* data,
     size_t len,
     const ManufacturerDataFormat& format
 ) {
     std::map<std::string,float> values;
-    if (!data || len < 2) return values;
+    parseFittingFields(data, len, format, [&](const DataFieldConfig& field, float value) {
+        values[field.sensorName] = value;
+    });
+    return values;
+}
+
+// -------------------------------------------------------------
+// ID-keyed readings: parse/pack without string keys or allocations
+// -------------------------------------------------------------
+using DeviceAddress = uint64_t;   // 48-bit BD_ADDR in the low bits
+
+struct SensorReading {
+    SensorNameId id;
+    float value;
+};
+
+inline const SensorReading* findReading(const SensorReading* readings, size_t count, SensorNameId id) {
+    for (size_t i = 0; i < count; ++i)
+        if (readings[i].id == id) return &readings[i];
+    return nullptr;
+}
+
+// Same decoding as parseManufacturerData, written to out[0..capacity).
+// Returns the number of readings produced.
+inline size_t parseManufacturerData(
+    const uint8_t* data,
+    size_t len,
+    const ManufacturerDataFormat& format,
+    SensorReading* out,
+    size_t capacity)
+{
+    BLE_COUNT_CYCLES(PARSE_CALLS, PARSE_CYCLES);
+    if (!data || len < 2 || !out) return 0;
+    BLE_COUNT_PACKETS(data[0] | (data[1] << 8), 1);
 
-    // Skip first two bytes (company ID)
     const uint8_t* payload = data + 2;
     size_t payloadLen = len - 2;
+    size_t count = 0;
 
     for (const auto& field : format.dataFields) {
-        size_t fieldLen = dataTypeSize(field.dataType);
-        if (field.offset + fieldLen > payloadLen) continue;
-
-        float parsedValue = 0.0f;
-
-        switch (field.dataType) {
-            case DataType::UINT8:   parsedValue = static_cast<float>(payload[field.offset]); break;
-            case DataType::INT8:    parsedValue = static_cast<float>(static_cast<int8_t>(payload[field.offset])); break;
-            case DataType::UINT16_LE:
-                parsedValue = static_cast<float>(payload[field.offset] | (payload[field.offset+1] << 8));
-                break;
-            case DataType::INT16_LE:
-                parsedValue = static_cast<float>(static_cast<int16_t>(payload[field.offset] | (payload[field.offset+1] << 8)));
-                break;
-            case DataType::UINT32_LE:
-                parsedValue = static_cast<float>(
-                    payload[field.offset] |
-                    (payload[field.offset+1] << 8) |
-                    (payload[field.offset+2] << 16) |
-                    (payload[field.offset+3] << 24)
-                );
-                break;
-            case DataType::FLOAT_LE:
-                {
-                    float val;
-                    memcpy(&val, payload + field.offset, sizeof(float));
-                    parsedValue = val;
-                }
-                break;
-            default: break;
+        if (count == capacity) break;
+        if (field.offset + fieldByteSize(field) > payloadLen) {
+            BLE_COUNT(FIELDS_OUT_OF_BOUNDS, 1);
+            continue;
         }
 
+        float parsedValue = parseFieldValue(payload, field);
         if (field.scale != 0.0f) parsedValue *= field.scale;
-        values[field.sensorName] = parsedValue;
+        out[count++] = { field.nameId, parsedValue };
+    }
+    return count;
+}
+
+// Same encoding as the map-based packManufacturerData, into a caller buffer.
+// Returns bytes written, or 0 when capacity is too small.
+inline size_t packManufacturerData(
+    const SensorReading* values,
+    size_t valueCount,
+    const ManufacturerDataFormat& format,
+    uint8_t* out,
+    size_t capacity)
+{
+    BLE_COUNT_CYCLES(PACK_CALLS, PACK_CYCLES);
+    size_t len = 2 + static_cast<size_t>(format.totalLength);
+    if (!out || capacity < len) return 0;
+    BLE_COUNT(PACKETS_PACKED, 1);
+
+    memset(out, 0, len);
+    out[0] = static_cast<uint8_t>(format.companyId & 0xFF);
+    out[1] = static_cast<uint8_t>((format.companyId >> 8) & 0xFF);
+
+    for (const auto& field : format.dataFields) {
+        const SensorReading* r = findReading(values, valueCount, field.nameId);
+        if (!r) continue;
+        if (field.offset + fieldByteSize(field) > format.totalLength) {
+            BLE_COUNT(FIELDS_OUT_OF_BOUNDS, 1);
+            continue;
+        }
+
+        float val = r->value * (1.0f / (field.scale != 0.0f ? field.scale : 1.0f));
+        packFieldValue(out + 2, field, val);
     }
+    return len;
+}
+
+// Edge conversion for export (JSON, logging)
+inline std::map<std::string, float> readingsToMap(const SensorReading* readings, size_t count) {
+    std::map<std::string, float> values;
+    for (size_t i = 0; i < count; ++i)
+        values[getSensorNameForId(readings[i].id)] = readings[i].value;
+    return values;
+}
+
+// -------------------------------------------------------------
+// Arena-backed map API (std::pmr)
+// Same results as the std::map overloads, but every node and key is
+// allocated from resource, e.g. a std::pmr::monotonic_buffer_resource
+// released once per scan window. Keys compare transparently, so
+// find("Temperature") or find(std::string_view) builds no temporary string.
+//
+//   std::pmr::monotonic_buffer_resource arena(64 * 1024);
+//   for (auto& adv : window) results.push_back(parseManufacturerData(adv.data, adv.len, fmt, &arena));
+// -------------------------------------------------------------
+#if defined(__cpp_lib_memory_resource)
+using PmrSensorValueMap = std::pmr::map<std::pmr::string, float, std::less<>>;
+
+inline PmrSensorValueMap parseManufacturerData(
+    const uint8_t* data,
+    size_t len,
+    const ManufacturerDataFormat& format,
+    std::pmr::memory_resource* resource)
+{
+    PmrSensorValueMap values(resource);
+    parseFittingFields(data, len, format, [&](const DataFieldConfig& field, float value) {
+        std::string_view name(field.sensorName);
+        auto it = values.find(name);
+        if (it != values.end()) it->second = value;
+        else values.emplace(name, value);
+    });
+    return values;
+}
+
+inline std::pmr::vector<uint8_t> packManufacturerData(
+    const PmrSensorValueMap& sensorValues,
+    const ManufacturerDataFormat& format,
+    std::pmr::memory_resource* resource)
+{
+    std::pmr::vector<uint8_t> data(2 + format.totalLength, 0, resource);
+    packFoundFields(data.data(), format, [&](const DataFieldConfig& field) -> const float* {
+        auto it = sensorValues.find(std::string_view(field.sensorName));
+        return it != sensorValues.end() ? &it->second : nullptr;
+    });
+    return data;
+}
 
+inline PmrSensorValueMap readingsToMap(const SensorReading* readings, size_t count,
+                                       std::pmr::memory_resource* resource) {
+    PmrSensorValueMap values(resource);
+    for (size_t i = 0; i < count; ++i) {
+        std::string_view name(getSensorNameForId(readings[i].id));
+        auto it = values.find(name);
+        if (it != values.end()) it->second = readings[i].value;
+        else values.emplace(name, readings[i].value);
+    }
     return values;
 }
+#endif
 
 // -------------------------------------------------------------
 // Utility: convert SensorGroup enum to string
@@ -277,23 +994,56 @@ inline const char* getSensorGroupName(SensorGroup group) {
 // -------------------------------------------------------------
 // Lookup utilities
 // -------------------------------------------------------------
+// Dense tables mirroring SENSOR_COMPANY_ID_MAP / COMPANY_ID_TO_GROUP so the
+// per-advert lookups are one subtraction, one compare and one load.
+inline constexpr uint16_t COMPANY_ID_FIRST = COMPANY_ID_ENVIRONMENTAL;
+
+inline constexpr SensorGroup COMPANY_ID_GROUP_TABLE[] = {
+    SensorGroup::ENVIRONMENTAL,   // COMPANY_ID_ENVIRONMENTAL
+    SensorGroup::AIR_QUALITY,     // COMPANY_ID_AIR_QUALITY
+    SensorGroup::MOTION,          // COMPANY_ID_MOTION
+    SensorGroup::AMBIENT,         // COMPANY_ID_AMBIENT
+    SensorGroup::SYSTEM,          // COMPANY_ID_SYSTEM
+    SensorGroup::CURRENT          // COMPANY_ID_CURRENT
+};
+
+inline constexpr uint16_t GROUP_COMPANY_ID_TABLE[] = {
+    COMPANY_ID_ENVIRONMENTAL,     // SensorGroup::ENVIRONMENTAL
+    COMPANY_ID_AIR_QUALITY,       // SensorGroup::AIR_QUALITY
+    COMPANY_ID_MOTION,            // SensorGroup::MOTION
+    COMPANY_ID_AMBIENT,           // SensorGroup::AMBIENT
+    COMPANY_ID_SYSTEM,            // SensorGroup::SYSTEM
+    COMPANY_ID_CURRENT            // SensorGroup::CURRENT
+};
+
+inline constexpr size_t KNOWN_GROUP_COUNT = sizeof(GROUP_COMPANY_ID_TABLE) / sizeof(GROUP_COMPANY_ID_TABLE[0]);
+
 inline uint16_t getCompanyIdForGroup(SensorGroup group) {
-    auto it = SENSOR_COMPANY_ID_MAP.find(group);
-    if (it != SENSOR_COMPANY_ID_MAP.end()) return it->second;
+    size_t idx = static_cast<size_t>(group);
+    if (idx < KNOWN_GROUP_COUNT) return GROUP_COMPANY_ID_TABLE[idx];
     return 0xFFFF;
 }
 
+// Table lookup only; for building tables, where a miss is not an unknown advert
+inline SensorGroup lookupGroupForCompanyId(uint16_t companyId) {
+    uint16_t idx = static_cast<uint16_t>(companyId - COMPANY_ID_FIRST);
+    return idx < KNOWN_GROUP_COUNT ? COMPANY_ID_GROUP_TABLE[idx] : SensorGroup::UNKNOWN;
+}
+
 inline SensorGroup getGroupForCompanyId(uint16_t companyId) {
-    auto it = COMPANY_ID_TO_GROUP.find(companyId);
-    if (it != COMPANY_ID_TO_GROUP.end()) return it->second;
-    return SensorGroup::UNKNOWN;
+    SensorGroup group = lookupGroupForCompanyId(companyId);
+    if (group == SensorGroup::UNKNOWN) BLE_COUNT(UNKNOWN_COMPANY_IDS, 1);
+    return group;
 }
 
 // -------------------------------------------------------------
 // Get all device profiles
+// Built once on first use (thread-safe) and never modified, so repeated
+// calls copy nothing and returned references stay valid.
 // -------------------------------------------------------------
-inline std::vector<DeviceProfile> getAllProfiles() {
-    return { createEnvironmentalProfile() };
+inline const std::vector<DeviceProfile>& getAllProfiles() {
+    static const std::vector<DeviceProfile> profiles = BuiltinProfiles::deviceProfiles();
+    return profiles;
 }
 
 } // namespace BLEProfiles
@@ -0,0 +1,213 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <cstring> // for memcpy, memset
+
+#include "BLEDeviceProfiles.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Fixed-point (raw integer) mode
+// For targets without an FPU. decode() and encode() move raw field
+// integers and never touch a float. Each field's scale is reduced once,
+// at construction, to a rational numerator / denominator, and where it
+// is a power of ten also to its exponent. Conversion to float or to a
+// decimal string happens only at export.
+//
+//   FixedPointFormat fx(profile.manufacturerFormat);
+//   int64_t raw[8];
+//   fx.decode(data, len, raw);                // integers only
+//   fx.formatValue(0, raw[0], buf, sizeof buf);   // "21.55", integers only
+//   float t = fx.toFloat(0, raw[0]);          // only when a float is wanted
+//
+// FLOAT_LE / FLOAT_BE fields carry their IEEE-754 bits as the raw value.
+// -------------------------------------------------------------
+inline constexpr int64_t FIXED_MISSING = INT64_MIN;   // raw value of a field that was not decoded
+
+struct FixedScale {
+    int32_t numerator;     // value = raw * numerator / denominator
+    int32_t denominator;
+    int8_t exponent10;     // value = raw * 10^exponent10 when isPowerOfTen
+    bool isPowerOfTen;
+    bool exact;            // numerator / denominator reproduces the float scale
+};
+
+// Reduce a float scale (0 means 1, as everywhere else) to a rational and,
+// when possible, a power of ten. Done once per field, so float use is fine.
+inline FixedScale fixedScaleFor(float scale) {
+    if (scale == 0.0f) scale = 1.0f;
+    double p = 1.0;
+    for (int e = 0; e <= 9; ++e, p *= 10.0) {
+        if (scale == static_cast<float>(p))
+            return { static_cast<int32_t>(p), 1, static_cast<int8_t>(e), true, true };
+        if (scale == static_cast<float>(1.0 / p))
+            return { 1, static_cast<int32_t>(p), static_cast<int8_t>(-e), true, true };
+    }
+
+    // Continued fraction convergents of |scale| with terms up to 2^31
+    const double target = std::fabs(static_cast<double>(scale));
+    const int32_t sign = scale < 0 ? -1 : 1;
+    int64_t h0 = 0, h1 = 1, k0 = 1, k1 = 0;
+    double x = target;
+    FixedScale best = { sign, 1, 0, false, false };
+    for (int i = 0; i < 32; ++i) {
+        double a = std::floor(x);
+        if (a > 2147483647.0) break;
+        int64_t h2 = static_cast<int64_t>(a) * h1 + h0;
+        int64_t k2 = static_cast<int64_t>(a) * k1 + k0;
+        if (h2 > INT32_MAX || k2 > INT32_MAX) break;
+        best = { static_cast<int32_t>(sign * h2), static_cast<int32_t>(k2), 0, false, false };
+        if (static_cast<float>(static_cast<double>(h2) / static_cast<double>(k2)) == static_cast<float>(target)) {
+            best.exact = true;
+            break;
+        }
+        h0 = h1; h1 = h2; k0 = k1; k1 = k2;
+        double frac = x - a;
+        if (frac <= 0.0) break;
+        x = 1.0 / frac;
+    }
+    return best;
+}
+
+struct FixedField {
+    DataFieldConfig config;
+    uint8_t size;         // fieldByteSize(config)
+    FixedScale scale;
+};
+
+class FixedPointFormat {
+public:
+    FixedPointFormat() : companyId(0), totalLength(0), minPayloadLength(0) {}
+
+    explicit FixedPointFormat(const ManufacturerDataFormat& format)
+        : companyId(format.companyId), totalLength(format.totalLength), minPayloadLength(0)
+    {
+        fields.reserve(format.dataFields.size());
+        for (const auto& f : format.dataFields) {
+            FixedField ff = { f, static_cast<uint8_t>(fieldByteSize(f)), fixedScaleFor(f.scale) };
+            fields.push_back(ff);
+
+            size_t end = static_cast<size_t>(f.offset) + ff.size;
+            if (end > minPayloadLength) minPayloadLength = end;
+        }
+    }
+
+    uint16_t companyId;
+    uint16_t totalLength;
+    size_t minPayloadLength;   // payload bytes needed for every field to decode
+    std::vector<FixedField> fields;
+
+    size_t fieldCount() const { return fields.size(); }
+
+    // Decode manufacturer data (company ID prefix included) into raw[0..fieldCount()).
+    // Fields past a short payload get FIXED_MISSING. Returns the number decoded.
+    size_t decode(const uint8_t* data, size_t len, int64_t* raw) const {
+        BLE_COUNT_CYCLES(PARSE_CALLS, PARSE_CYCLES);
+        const size_t payloadLen = (data && len >= 2) ? len - 2 : 0;
+        if (payloadLen) BLE_COUNT_PACKETS(data[0] | (data[1] << 8), 1);
+        if (payloadLen && payloadLen >= minPayloadLength) {
+            for (size_t i = 0; i < fields.size(); ++i) raw[i] = loadFieldRaw(data + 2, fields[i].config);
+            return fields.size();
+        }
+
+        size_t decoded = 0;
+        for (size_t i = 0; i < fields.size(); ++i) {
+            const FixedField& f = fields[i];
+            if (payloadLen == 0 || static_cast<size_t>(f.config.offset) + f.size > payloadLen) {
+                BLE_COUNT(FIELDS_OUT_OF_BOUNDS, 1);
+                raw[i] = FIXED_MISSING;
+                continue;
+            }
+            raw[i] = loadFieldRaw(data + 2, f.config);
+            ++decoded;
+        }
+        return decoded;
+    }
+
+    // Encode raw[0..fieldCount()) into out (company ID prefix + totalLength
+    // bytes). FIXED_MISSING fields stay zero. Returns the bytes written, or 0
+    // when capacity is too small or a field lies past totalLength.
+    size_t encode(const int64_t* raw, uint8_t* out, size_t capacity) const {
+        BLE_COUNT_CYCLES(PACK_CALLS, PACK_CYCLES);
+        const size_t len = 2 + static_cast<size_t>(totalLength);
+        if (!out || capacity < len) return 0;
+        for (const auto& f : fields)
+            if (static_cast<size_t>(f.config.offset) + f.size > totalLength) return 0;
+        BLE_COUNT(PACKETS_PACKED, 1);
+
+        out[0] = static_cast<uint8_t>(companyId & 0xFF);
+        out[1] = static_cast<uint8_t>((companyId >> 8) & 0xFF);
+        memset(out + 2, 0, totalLength);
+        for (size_t i = 0; i < fields.size(); ++i)
+            if (raw[i] != FIXED_MISSING) storeFieldRaw(out + 2, fields[i].config, raw[i]);
+        return len;
+    }
+
+    // Raw value for a value given as mantissa * 10^exponent10 in sensor units,
+    // e.g. a temperature in centidegrees is (centi, -2). Integer arithmetic,
+    // truncated toward zero. Not meaningful for FLOAT fields.
+    int64_t rawFromDecimal(size_t i, int64_t mantissa, int exponent10) const {
+        const FixedScale& s = fields[i].scale;
+        // raw = mantissa * 10^exponent10 * denominator / numerator
+        int64_t num = mantissa * s.denominator;
+        int64_t den = s.numerator;
+        for (; exponent10 > 0; --exponent10) num *= 10;
+        for (; exponent10 < 0; ++exponent10) den *= 10;
+        return den ? num / den : 0;
+    }
+
+    // Export conversions. A FIXED_MISSING value converts to NaN.
+    double toDouble(size_t i, int64_t raw) const {
+        if (raw == FIXED_MISSING) return std::numeric_limits<double>::quiet_NaN();
+        const FixedField& f = fields[i];
+        const FixedScale& s = f.scale;
+        double v = static_cast<double>(raw);
+        if (isFloatType(f.config.dataType)) {
+            uint32_t bits = static_cast<uint32_t>(raw);
+            float fv;
+            memcpy(&fv, &bits, sizeof(fv));
+            v = fv;
+        }
+        return v * s.numerator / s.denominator;
+    }
+
+    float toFloat(size_t i, int64_t raw) const { return static_cast<float>(toDouble(i, raw)); }
+
+    // Decimal text of raw in sensor units without floating point when the
+    // scale is a power of ten (e.g. raw 2155, scale 0.01 -> "21.55");
+    // other scales and FLOAT fields fall back to %g. Returns snprintf's result.
+    int formatValue(size_t i, int64_t raw, char* buf, size_t size) const {
+        const FixedField& f = fields[i];
+        const FixedScale& s = f.scale;
+        if (raw == FIXED_MISSING) return snprintf(buf, size, "nan");
+        if (!s.isPowerOfTen || isFloatType(f.config.dataType))
+            return snprintf(buf, size, "%g", toDouble(i, raw));
+
+        const bool negative = raw < 0;
+        uint64_t mag = negative ? 0 - static_cast<uint64_t>(raw) : static_cast<uint64_t>(raw);
+        char digits[40];
+        int n = 0;
+        if (s.exponent10 >= 0) {
+            for (int e = 0; e < s.exponent10 && mag; ++e) digits[n++] = '0';
+        }
+        int fractional = s.exponent10 < 0 ? -s.exponent10 : 0;
+        do {
+            if (n == fractional && fractional > 0) digits[n++] = '.';
+            digits[n++] = static_cast<char>('0' + mag % 10);
+            mag /= 10;
+        } while (mag || n <= fractional);
+        if (negative) digits[n++] = '-';
+
+        size_t written = 0;
+        for (int k = n - 1; k >= 0 && written + 1 < size; --k) buf[written++] = digits[k];
+        if (size) buf[written] = '\0';
+        return n;
+    }
+};
+
+} // namespace BLEProfiles
@@ -0,0 +1,164 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#if defined(_MSC_VER)
+#include <intrin.h> // for _BitScanForward64
+#endif
+
+#include "BLEDeviceProfiles.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Unknown-format fingerprinting
+// Suggests candidate profiles for manufacturer data whose company ID
+// is not registered, from the payload alone. A format matches when
+//   - the payload is exactly its totalLength bytes, and
+//   - every bit no field covers (padding, gaps, unused bit-field bits)
+//     is zero, which is how packManufacturerData leaves them.
+//
+// Both tests run as bit-set intersections: one candidate mask per
+// payload length and, for the first FINGERPRINT_INDEXED_BYTES payload
+// bytes, one mask per (position, byte value). Only the surviving
+// candidates check their remaining bytes. A format without gaps is
+// matched by length alone, so the result is a candidate list, not a
+// verdict.
+//
+//   FormatFingerprintIndex index(getAllProfiles());
+//   const DeviceProfile* candidates[4];
+//   size_t n = index.classify(data, len, candidates, 4);
+// -------------------------------------------------------------
+inline constexpr size_t FINGERPRINT_INDEXED_BYTES = 8;
+inline constexpr size_t FINGERPRINT_MAX_PAYLOAD   = 255;
+
+// Index of the lowest set bit; m must be non-zero
+inline unsigned lowestSetBit(uint64_t m) {
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward64(&i, m);
+    return static_cast<unsigned>(i);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(m));
+#endif
+}
+
+// Bits of each payload byte of format that no field covers
+inline std::vector<uint8_t> unusedPayloadBits(const ManufacturerDataFormat& format) {
+    std::vector<uint8_t> unused(format.totalLength, 0xFF);
+    for (const auto& f : format.dataFields) {
+        size_t size = fieldByteSize(f);
+        if (isBitFieldType(f.dataType)) {
+            size_t first = clampBitOffset(f.bitOffset);
+            for (size_t bit = first; bit < first + clampBitWidth(f.bitWidth); ++bit) {
+                size_t byte = f.offset + bit / 8;
+                if (byte < unused.size()) unused[byte] &= static_cast<uint8_t>(~(1u << (bit % 8)));
+            }
+            continue;
+        }
+        for (size_t b = f.offset; b < static_cast<size_t>(f.offset) + size && b < unused.size(); ++b)
+            unused[b] = 0;
+    }
+    return unused;
+}
+
+class FormatFingerprintIndex {
+public:
+    // profiles must outlive the index. Formats with fields past totalLength, or
+    // longer than one advert can carry (FINGERPRINT_MAX_PAYLOAD), are skipped.
+    explicit FormatFingerprintIndex(const std::vector<DeviceProfile>& profiles) {
+        for (const auto& p : profiles) {
+            const ManufacturerDataFormat& fmt = p.manufacturerFormat;
+            bool fits = fmt.totalLength > 0 && fmt.totalLength <= FINGERPRINT_MAX_PAYLOAD;
+            for (const auto& f : fmt.dataFields)
+                if (static_cast<size_t>(f.offset) + fieldByteSize(f) > fmt.totalLength) fits = false;
+            if (!fits) continue;
+
+            Signature s;
+            s.profile = &p;
+            s.length = fmt.totalLength;
+            s.maskOffset = unused_.size();
+            s.unusedBits = 0;
+            std::vector<uint8_t> unused = unusedPayloadBits(fmt);
+            for (uint8_t u : unused)
+                for (uint8_t m = u; m; m &= static_cast<uint8_t>(m - 1)) ++s.unusedBits;
+            unused_.insert(unused_.end(), unused.begin(), unused.end());
+            signatures_.push_back(s);
+        }
+
+        // Most constrained formats first, so candidates come back best evidence first
+        std::stable_sort(signatures_.begin(), signatures_.end(),
+                         [](const Signature& a, const Signature& b) { return a.unusedBits > b.unusedBits; });
+
+        words_ = (signatures_.size() + 63) / 64;
+        byLength_.assign((FINGERPRINT_MAX_PAYLOAD + 1) * words_, 0);
+        byByte_.assign(FINGERPRINT_INDEXED_BYTES * 256 * words_, ~0ull);
+
+        for (size_t i = 0; i < signatures_.size(); ++i) {
+            const Signature& s = signatures_[i];
+            const uint64_t bit = 1ull << (i % 64);
+            const size_t w = i / 64;
+            byLength_[s.length * words_ + w] |= bit;
+            for (size_t pos = 0; pos < FINGERPRINT_INDEXED_BYTES && pos < s.length; ++pos) {
+                const uint8_t unused = unused_[s.maskOffset + pos];
+                for (unsigned v = 0; v < 256; ++v)
+                    if (v & unused) byByte_[(pos * 256 + v) * words_ + w] &= ~bit;
+            }
+        }
+    }
+
+    size_t size() const { return signatures_.size(); }
+
+    // Candidate profiles for manufacturer data (company ID prefix included;
+    // the ID itself is ignored). Writes at most capacity candidates to out,
+    // most constrained format first, and returns how many were written.
+    size_t classify(const uint8_t* data, size_t len, const DeviceProfile** out, size_t capacity) const {
+        if (!data || len < 2 || len - 2 > FINGERPRINT_MAX_PAYLOAD || !out) return 0;
+        const uint8_t* payload = data + 2;
+        const size_t payloadLen = len - 2;
+        const size_t indexed = payloadLen < FINGERPRINT_INDEXED_BYTES ? payloadLen : FINGERPRINT_INDEXED_BYTES;
+
+        size_t count = 0;
+        for (size_t w = 0; w < words_ && count < capacity; ++w) {
+            uint64_t m = byLength_[payloadLen * words_ + w];
+            for (size_t pos = 0; pos < indexed && m; ++pos)
+                m &= byByte_[(pos * 256 + payload[pos]) * words_ + w];
+
+            for (; m && count < capacity; m &= m - 1) {
+                const Signature& s = signatures_[w * 64 + lowestSetBit(m)];
+                if (tailMatches(s, payload)) out[count++] = s.profile;
+            }
+        }
+        return count;
+    }
+
+    // First candidate, or nullptr when no registered format fits
+    const DeviceProfile* bestMatch(const uint8_t* data, size_t len) const {
+        const DeviceProfile* p = nullptr;
+        return classify(data, len, &p, 1) ? p : nullptr;
+    }
+
+private:
+    struct Signature {
+        const DeviceProfile* profile;
+        size_t length;
+        size_t maskOffset;   // into unused_
+        size_t unusedBits;   // bits that must be zero
+    };
+
+    bool tailMatches(const Signature& s, const uint8_t* payload) const {
+        const uint8_t* unused = unused_.data() + s.maskOffset;
+        uint8_t stray = 0;
+        for (size_t b = FINGERPRINT_INDEXED_BYTES; b < s.length; ++b) stray |= payload[b] & unused[b];
+        return stray == 0;
+    }
+
+    std::vector<Signature> signatures_;
+    std::vector<uint8_t> unused_;     // unusedPayloadBits() of every signature, concatenated
+    size_t words_;
+    std::vector<uint64_t> byLength_;  // [length][word]
+    std::vector<uint64_t> byByte_;    // [position][value][word]
+};
+
+} // namespace BLEProfiles
@@ -0,0 +1,219 @@
+#pragma once
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include <cstring> // for memcpy
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Scatter-gather payloads
+// Manufacturer data (company ID prefix included) that arrives in
+// several buffers, e.g. extended advertising chains or the indications
+// of a SYSTEM diagnostic dump, is described by a list of segments.
+// decodeSegments() reads each field in place. Only a field that
+// straddles a segment boundary is gathered, into a few stack bytes,
+// so the payload is never copied into one contiguous buffer.
+// -------------------------------------------------------------
+struct BufferSegment {
+    const uint8_t* data;
+    size_t size;
+};
+
+inline constexpr size_t SEGMENT_GATHER_MAX_BYTES = 8;   // covers every field type and bit span
+
+// Logical concatenation of segments; does not own or copy them
+class SegmentedBuffer {
+public:
+    SegmentedBuffer() : segments_(nullptr), count_(0), size_(0) {}
+
+    SegmentedBuffer(const BufferSegment* segments, size_t count)
+        : segments_(segments), count_(count), size_(0)
+    {
+        for (size_t i = 0; i < count; ++i) size_ += segments[i].size;
+    }
+
+    size_t size() const { return size_; }
+    size_t segmentCount() const { return count_; }
+    const BufferSegment& segment(size_t i) const { return segments_[i]; }
+
+    // Pointer to len bytes starting at offset. Points into a segment when the
+    // range lies inside one; otherwise the bytes are gathered into scratch
+    // (len <= SEGMENT_GATHER_MAX_BYTES). nullptr when the range runs past the end.
+    const uint8_t* contiguous(size_t offset, size_t len, uint8_t* scratch) const {
+        if (offset > size_ || len > size_ - offset) return nullptr;
+        size_t i = 0;
+        while (i < count_ && offset >= segments_[i].size) offset -= segments_[i++].size;
+        if (i == count_) return len == 0 ? scratch : nullptr;
+        if (segments_[i].size - offset >= len) return segments_[i].data + offset;
+        if (len > SEGMENT_GATHER_MAX_BYTES) return nullptr;
+        copySpan(i, offset, len, scratch);
+        return scratch;
+    }
+
+    // Copy len bytes starting at offset into dst; false when past the end
+    bool copy(size_t offset, size_t len, uint8_t* dst) const {
+        if (offset > size_ || len > size_ - offset) return false;
+        size_t i = 0;
+        while (i < count_ && offset >= segments_[i].size) offset -= segments_[i++].size;
+        copySpan(i, offset, len, dst);
+        return true;
+    }
+
+private:
+    void copySpan(size_t i, size_t offset, size_t len, uint8_t* dst) const {
+        while (len) {
+            size_t n = segments_[i].size - offset;
+            if (n > len) n = len;
+            memcpy(dst, segments_[i].data + offset, n);
+            dst += n;
+            len -= n;
+            offset = 0;
+            ++i;
+        }
+    }
+
+    const BufferSegment* segments_;
+    size_t count_;
+    size_t size_;
+};
+
+// Same contract as CompiledFormat::decode() for manufacturer data held in
+// segments: fields that do not fit are set to NaN; returns the number decoded.
+inline size_t decodeSegments(const CompiledFormat& format, const SegmentedBuffer& data, float* out) {
+    BLE_COUNT_CYCLES(PARSE_CALLS, PARSE_CYCLES);
+    uint8_t scratch[SEGMENT_GATHER_MAX_BYTES];
+    const uint8_t* id = data.contiguous(0, 2, scratch);
+    if (!id) {
+        for (size_t i = 0; i < format.fieldCount(); ++i)
+            out[i] = std::numeric_limits<float>::quiet_NaN();
+        return 0;
+    }
+    BLE_COUNT_PACKETS(id[0] | (id[1] << 8), 1);
+
+    size_t decoded = 0;
+    for (size_t i = 0; i < format.fieldCount(); ++i) {
+        const CompiledField& f = format.fields[i];
+        const uint8_t* p = data.contiguous(2 + static_cast<size_t>(f.offset), f.size, scratch);
+        if (!p) {
+            BLE_COUNT(FIELDS_OUT_OF_BOUNDS, 1);
+            out[i] = std::numeric_limits<float>::quiet_NaN();
+            continue;
+        }
+        out[i] = loadCompiledFieldAt(f, p);
+        ++decoded;
+    }
+    return decoded;
+}
+
+// -------------------------------------------------------------
+// Fragmentation
+// Payloads larger than one packet are sent as numbered fragments:
+//
+//   [FRAGMENT_LAST_FLAG | index:1][body]
+//
+// The bodies, in index order, concatenate to the manufacturer data
+// (company ID prefix included, so it is in fragment 0). The last
+// fragment sets FRAGMENT_LAST_FLAG. Fragments may arrive in any order.
+// -------------------------------------------------------------
+inline constexpr uint8_t FRAGMENT_LAST_FLAG     = 0x80;
+inline constexpr uint8_t FRAGMENT_INDEX_MASK    = 0x7F;
+inline constexpr size_t  FRAGMENT_HEADER_LENGTH = 1;
+inline constexpr size_t  FRAGMENT_MAX_COUNT     = 128;
+
+// Number of fragments for len bytes of manufacturer data with bodyBytes per fragment
+inline size_t fragmentCount(size_t len, size_t bodyBytes) {
+    if (bodyBytes == 0) return 0;
+    return len ? (len + bodyBytes - 1) / bodyBytes : 1;
+}
+
+// Write fragment index of data into out. Returns bytes written, or 0 when
+// index is out of range, capacity is too small or more than
+// FRAGMENT_MAX_COUNT fragments would be needed.
+inline size_t encodeFragment(const uint8_t* data, size_t len, size_t bodyBytes, size_t index,
+                             uint8_t* out, size_t capacity)
+{
+    size_t count = fragmentCount(len, bodyBytes);
+    if (!out || count == 0 || count > FRAGMENT_MAX_COUNT || index >= count) return 0;
+    size_t start = index * bodyBytes;
+    size_t n = len - start < bodyBytes ? len - start : bodyBytes;
+    if (capacity < FRAGMENT_HEADER_LENGTH + n) return 0;
+    out[0] = static_cast<uint8_t>(index | (index + 1 == count ? FRAGMENT_LAST_FLAG : 0));
+    if (n) memcpy(out + FRAGMENT_HEADER_LENGTH, data + start, n);
+    return FRAGMENT_HEADER_LENGTH + n;
+}
+
+// -------------------------------------------------------------
+// Receiver side: one assembler per device (or per characteristic)
+// add() records where each fragment body lies and does not copy it.
+// The caller keeps every added buffer alive until the payload has been
+// decoded and reset() was called. Fragments carry no transfer ID, so
+// call reset() when a transfer times out.
+//
+//   FragmentAssembler assembler;
+//   if (assembler.add(pkt, len)) {   // true once the payload is complete
+//       decodeSegments(compiled, assembler.payload(), values);
+//       assembler.reset();
+//   }
+// -------------------------------------------------------------
+class FragmentAssembler {
+public:
+    FragmentAssembler() : count_(0), receivedCount_(0) {
+        for (size_t i = 0; i < FRAGMENT_MAX_COUNT; ++i) received_[i] = false;
+    }
+
+    // Add one fragment, header byte included. A repeated index replaces the
+    // earlier body; a fragment past the known last index starts over.
+    // Returns true when every fragment up to the last has arrived.
+    bool add(const uint8_t* data, size_t len) {
+        if (!data || len < FRAGMENT_HEADER_LENGTH) return false;
+        size_t index = data[0] & FRAGMENT_INDEX_MASK;
+        bool last = (data[0] & FRAGMENT_LAST_FLAG) != 0;
+
+        if (count_ && (index >= count_ || (last && index + 1 != count_))) reset();
+        if (last && !count_) {
+            count_ = index + 1;
+            for (size_t i = count_; i < FRAGMENT_MAX_COUNT; ++i) drop(i);   // stale, from an older transfer
+        }
+
+        if (!received_[index]) {
+            received_[index] = true;
+            ++receivedCount_;
+        }
+        segments_[index] = { data + FRAGMENT_HEADER_LENGTH, len - FRAGMENT_HEADER_LENGTH };
+        return complete();
+    }
+
+    bool complete() const { return count_ && receivedCount_ == count_; }
+
+    // Assembled manufacturer data; empty until complete()
+    SegmentedBuffer payload() const {
+        return complete() ? SegmentedBuffer(segments_, count_) : SegmentedBuffer();
+    }
+
+    size_t expectedFragments() const { return count_; }   // 0 until the last fragment arrived
+    size_t receivedFragments() const { return receivedCount_; }
+
+    void reset() {
+        for (size_t i = 0; i < FRAGMENT_MAX_COUNT; ++i) received_[i] = false;
+        count_ = 0;
+        receivedCount_ = 0;
+    }
+
+private:
+    void drop(size_t i) {
+        if (!received_[i]) return;
+        received_[i] = false;
+        --receivedCount_;
+    }
+
+    BufferSegment segments_[FRAGMENT_MAX_COUNT];
+    bool received_[FRAGMENT_MAX_COUNT];
+    size_t count_;           // last index + 1, once the last fragment arrived
+    size_t receivedCount_;
+};
+
+} // namespace BLEProfiles
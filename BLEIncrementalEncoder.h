@@ -0,0 +1,77 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring> // for memcpy, memcmp
+#include <limits>
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Incremental advert encoder
+// Keeps the last encoded manufacturer data for one profile and
+// re-encodes only fields whose input value changed. update() reports
+// whether the advert bytes changed, so callers can skip pushing
+// identical advertising data to the BLE controller.
+//
+//   IncrementalEncoder enc(createEnvironmentalProfile());
+//   if (enc.update(values, 4)) setAdvertData(enc.data(), enc.size());
+// -------------------------------------------------------------
+class IncrementalEncoder {
+public:
+    explicit IncrementalEncoder(const DeviceProfile& profile)
+        : format_(profile.manufacturerFormat),
+          buffer_(2 + static_cast<size_t>(profile.manufacturerFormat.totalLength), 0),
+          lastValues_(format_.fields.size(), std::numeric_limits<float>::quiet_NaN())
+    {
+        buffer_[0] = static_cast<uint8_t>(format_.companyId & 0xFF);
+        buffer_[1] = static_cast<uint8_t>((format_.companyId >> 8) & 0xFF);
+    }
+
+    // values[i] belongs to field i; NaN clears the field to zero like a
+    // missing value in packManufacturerData. Returns true when any byte changed.
+    bool update(const float* values, size_t count) {
+        size_t n = count < lastValues_.size() ? count : lastValues_.size();
+        bool changed = false;
+        for (size_t i = 0; i < n; ++i)
+            changed |= setField(i, values[i]);
+        return changed;
+    }
+
+    // Update one field by ordinal. Returns true when its bytes changed.
+    bool setField(size_t index, float value) {
+        if (index >= lastValues_.size() || sameValue(lastValues_[index], value)) return false;
+        lastValues_[index] = value;
+
+        // Bit fields share bytes with their neighbours, so encode in place
+        // and compare against the previous bytes
+        uint8_t before[8];
+        const CompiledField& f = format_.fields[index];
+        if (static_cast<size_t>(f.offset) + f.size > format_.totalLength || f.size > sizeof(before)) return false;
+
+        uint8_t* payload = buffer_.data() + 2;
+        memcpy(before, payload + f.offset, f.size);
+        clearCompiledField(f, payload);
+        if (value == value) storeCompiledField(f, payload, value);
+        return memcmp(before, payload + f.offset, f.size) != 0;
+    }
+
+    // Current manufacturer data, company ID prefix included
+    const uint8_t* data() const { return buffer_.data(); }
+    size_t size() const { return buffer_.size(); }
+
+    const CompiledFormat& format() const { return format_; }
+
+private:
+    // Bitwise comparison, so NaN == NaN and -0.0f != 0.0f
+    static bool sameValue(float a, float b) { return memcmp(&a, &b, sizeof(float)) == 0; }
+
+    CompiledFormat format_;
+    std::vector<uint8_t> buffer_;
+    std::vector<float> lastValues_;
+};
+
+} // namespace BLEProfiles
@@ -0,0 +1,350 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring> // for memcpy
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+#include "BLECompanyDispatch.h"
+#include "BLEBatchDecode.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Raw advert record as captured by a radio thread
+// bytes holds the manufacturer data including the company ID prefix
+// -------------------------------------------------------------
+inline constexpr size_t RAW_ADVERT_MAX_BYTES = 31;
+
+struct RawAdvert {
+    uint16_t companyId;
+    uint8_t length;
+    int8_t rssi;
+    uint64_t timestamp;
+    uint8_t bytes[RAW_ADVERT_MAX_BYTES];
+};
+
+// Fill rec from manufacturer data; false when len is outside [2, RAW_ADVERT_MAX_BYTES]
+inline bool makeRawAdvert(RawAdvert& rec, const uint8_t* data, size_t len, int8_t rssi, uint64_t timestamp) {
+    if (!data || len < 2 || len > RAW_ADVERT_MAX_BYTES) return false;
+    rec.companyId = static_cast<uint16_t>(data[0] | (data[1] << 8));
+    rec.length = static_cast<uint8_t>(len);
+    rec.rssi = rssi;
+    rec.timestamp = timestamp;
+    memcpy(rec.bytes, data, len);
+    return true;
+}
+
+// -------------------------------------------------------------
+// Bounded lock-free single-producer / single-consumer ring
+// Capacity is rounded up to a power of two.
+// -------------------------------------------------------------
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) : head_(0), tail_(0) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        slots_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side. Returns false when the ring is full.
+    bool push(const T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_) return false;
+        slots_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Moves up to maxItems into out, returns the count.
+    size_t popBatch(T* out, size_t maxItems) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t available = tail_.load(std::memory_order_acquire) - head;
+        size_t n = available < maxItems ? available : maxItems;
+        for (size_t i = 0; i < n; ++i) out[i] = slots_[(head + i) & mask_];
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+};
+
+// -------------------------------------------------------------
+// Decoded output handed to the sink, one batch per company ID
+// columns[i] holds count values of format->fields[i]
+// -------------------------------------------------------------
+struct DecodedAdvertBatch {
+    SensorGroup group;
+    uint16_t companyId;
+    const CompiledFormat* format;
+    size_t count;
+    std::vector<std::vector<float>> columns;
+    std::vector<uint64_t> timestamps;
+    std::vector<int8_t> rssi;
+
+    DecodedAdvertBatch() : group(SensorGroup::UNKNOWN), companyId(0), format(nullptr), count(0) {}
+};
+
+// -------------------------------------------------------------
+// Routes a block of raw adverts by company ID and column-decodes each
+// route with decodeBatch. Buffers are kept between calls, so a reused
+// decoder stops allocating once it has seen every company ID. The
+// dispatch table must outlive the decoder.
+// -------------------------------------------------------------
+class AdvertBatchDecoder {
+public:
+    explicit AdvertBatchDecoder(const CompanyDispatchTable& table) : table_(&table), unknown_(0) {}
+
+    // Decode records[0..n); replaces the previous result. Returns the
+    // number of records decoded (the rest had no compiled format).
+    size_t decode(const RawAdvert* records, size_t n) {
+        for (auto& route : routes_) {
+            route.packets.clear();
+            route.lengths.clear();
+            route.batch.timestamps.clear();
+            route.batch.rssi.clear();
+            route.batch.count = 0;
+        }
+
+        unknown_ = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const RawAdvert& rec = records[i];
+            const CompanyDispatchEntry* entry = table_->find(rec.companyId);
+            if (!entry || entry->format.fields.empty()) { ++unknown_; continue; }
+
+            Route* route = nullptr;
+            for (auto& r : routes_) if (r.entry == entry) { route = &r; break; }
+            if (!route) {
+                routes_.emplace_back();
+                route = &routes_.back();
+                route->entry = entry;
+                route->batch.group = entry->group;
+                route->batch.companyId = entry->companyId;
+                route->batch.format = &entry->format;
+                route->batch.columns.resize(entry->format.fields.size());
+            }
+            route->packets.push_back(rec.bytes);
+            route->lengths.push_back(rec.length);
+            route->batch.timestamps.push_back(rec.timestamp);
+            route->batch.rssi.push_back(rec.rssi);
+        }
+
+        size_t decoded = 0;
+        for (auto& route : routes_) {
+            size_t count = route.packets.size();
+            if (count == 0) continue;
+
+            route.columnPtrs.clear();
+            for (auto& col : route.batch.columns) {
+                if (col.size() < count) col.resize(count);
+                route.columnPtrs.push_back(col.data());
+            }
+            decodeBatch(*route.batch.format, route.packets.data(), route.lengths.data(),
+                        count, route.columnPtrs.data());
+            route.batch.count = count;
+            decoded += count;
+        }
+        return decoded;
+    }
+
+    // Calls f(const DecodedAdvertBatch&) for every company ID in the last decode()
+    template <typename F>
+    void forEachBatch(F&& f) const {
+        for (const auto& route : routes_)
+            if (route.batch.count) f(route.batch);
+    }
+
+    // Records of the last decode() without a compiled format
+    size_t unknown() const { return unknown_; }
+
+private:
+    struct Route {
+        const CompanyDispatchEntry* entry;
+        std::vector<const uint8_t*> packets;
+        std::vector<size_t> lengths;
+        std::vector<float*> columnPtrs;
+        DecodedAdvertBatch batch;
+    };
+
+    const CompanyDispatchTable* table_;
+    std::vector<Route> routes_;
+    size_t unknown_;
+};
+
+struct IngestStats {
+    uint64_t accepted;   // records pushed into a ring
+    uint64_t dropped;    // records rejected because the ring was full
+    uint64_t decoded;    // records delivered to the sink
+    uint64_t unknown;    // records whose company ID has no compiled format
+};
+
+// -------------------------------------------------------------
+// Ingestion pipeline
+// Each producer (radio thread) owns one SPSC ring. Any idle worker may
+// claim a non-empty ring, pop up to batchSize records and release it
+// again before decoding, so the ring keeps one consumer at a time while
+// several workers decode batches from the same ring: decode throughput
+// scales with workers even when there are fewer producers. Each batch is
+// routed through the dispatch table and sink is called once per company
+// ID per batch. The sink runs on worker threads and must tolerate
+// concurrent calls, for the same group too; batches from one producer
+// may reach it out of order. The dispatch table must outlive the pipeline.
+// -------------------------------------------------------------
+class IngestPipeline {
+public:
+    using Sink = std::function<void(const DecodedAdvertBatch&)>;
+
+    IngestPipeline(const CompanyDispatchTable& table,
+                   size_t producerCount,
+                   size_t workerCount,
+                   Sink sink,
+                   size_t ringCapacity = 4096,
+                   size_t batchSize = 256)
+        : table_(table), sink_(std::move(sink)),
+          workerCount_(workerCount ? workerCount : 1),
+          batchSize_(batchSize ? batchSize : 1),
+          running_(false),
+          accepted_(0), dropped_(0), decoded_(0), unknown_(0)
+    {
+        for (size_t i = 0; i < producerCount; ++i)
+            rings_.emplace_back(new Ring(ringCapacity));
+    }
+
+    ~IngestPipeline() { stop(); }
+
+    IngestPipeline(const IngestPipeline&) = delete;
+    IngestPipeline& operator=(const IngestPipeline&) = delete;
+
+    void start() {
+        if (running_.exchange(true)) return;
+        for (size_t w = 0; w < workerCount_; ++w)
+            workers_.emplace_back([this, w] { workerLoop(w); });
+    }
+
+    // Stops the workers after they drain what is already queued
+    void stop() {
+        if (!running_.exchange(false)) return;
+        for (auto& t : workers_) t.join();
+        workers_.clear();
+    }
+
+    // Called only from the thread that owns producer index. Returns false
+    // when the record is too long or the ring is full (the record is dropped).
+    bool push(size_t producer, const uint8_t* data, size_t len, int8_t rssi, uint64_t timestamp) {
+        RawAdvert rec;
+        if (producer >= rings_.size() || !makeRawAdvert(rec, data, len, rssi, timestamp)) return false;
+
+        if (!rings_[producer]->queue.push(rec)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        accepted_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    IngestStats stats() const {
+        return { accepted_.load(std::memory_order_relaxed),
+                 dropped_.load(std::memory_order_relaxed),
+                 decoded_.load(std::memory_order_relaxed),
+                 unknown_.load(std::memory_order_relaxed) };
+    }
+
+    size_t producerCount() const { return rings_.size(); }
+
+private:
+    // SPSC ring whose consumer side is claimed by one worker at a time
+    struct Ring {
+        explicit Ring(size_t capacity) : queue(capacity), claimed(false) {}
+
+        SpscRing<RawAdvert> queue;
+        alignas(64) std::atomic<bool> claimed;
+    };
+
+    // Pop up to maxItems from ring unless another worker holds it; *busy is
+    // set when it does. The claim's acquire / release orders the consumers.
+    static size_t tryPopBatch(Ring& ring, RawAdvert* out, size_t maxItems, bool* busy) {
+        if (ring.queue.empty()) return 0;
+        if (ring.claimed.exchange(true, std::memory_order_acquire)) {
+            *busy = true;
+            return 0;
+        }
+        size_t n = ring.queue.popBatch(out, maxItems);
+        ring.claimed.store(false, std::memory_order_release);
+        return n;
+    }
+
+    void workerLoop(size_t worker) {
+        std::vector<RawAdvert> records(batchSize_);
+        AdvertBatchDecoder decoder(table_);
+        unsigned idleRounds = 0;
+
+        for (;;) {
+            bool stopping = !running_.load(std::memory_order_acquire);
+            bool busy = false;
+            size_t drained = 0;
+
+            // Start at a different ring per worker to spread the claims
+            for (size_t k = 0; k < rings_.size(); ++k) {
+                Ring& ring = *rings_[(worker + k) % rings_.size()];
+                size_t n = tryPopBatch(ring, records.data(), records.size(), &busy);
+                if (n == 0) continue;
+                drained += n;
+                decodeRecords(records.data(), n, decoder);
+            }
+
+            if (drained) {
+                idleRounds = 0;
+            } else if (stopping && !busy) {
+                return;
+            } else if (busy || ++idleRounds < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+    void decodeRecords(const RawAdvert* records, size_t n, AdvertBatchDecoder& decoder) {
+        decoder.decode(records, n);
+        if (decoder.unknown()) unknown_.fetch_add(decoder.unknown(), std::memory_order_relaxed);
+        decoder.forEachBatch([this](const DecodedAdvertBatch& batch) {
+            sink_(batch);
+            decoded_.fetch_add(batch.count, std::memory_order_relaxed);
+        });
+    }
+
+    const CompanyDispatchTable& table_;
+    Sink sink_;
+    size_t workerCount_;
+    size_t batchSize_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+    std::vector<std::thread> workers_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> accepted_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> decoded_;
+    std::atomic<uint64_t> unknown_;
+};
+
+} // namespace BLEProfiles
@@ -0,0 +1,109 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define BLE_PROFILES_HAVE_MMAP 1
+#else
+#define BLE_PROFILES_HAVE_MMAP 0
+#endif
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Read-only file mapping
+// mmap where <sys/mman.h> exists, otherwise the file is read into a
+// heap buffer. Either way data() stays valid until the object is
+// destroyed or reopened.
+// -------------------------------------------------------------
+class MappedFile {
+public:
+    MappedFile() : data_(nullptr), size_(0), mapped_(false) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : data_(other.data_), size_(other.size_), mapped_(other.mapped_), copy_(std::move(other.copy_)) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mapped_ = false;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            data_ = other.data_;
+            size_ = other.size_;
+            mapped_ = other.mapped_;
+            copy_ = std::move(other.copy_);
+            other.data_ = nullptr;
+            other.size_ = 0;
+            other.mapped_ = false;
+        }
+        return *this;
+    }
+
+    // sequential: hint that the file will be read front to back once.
+    // Returns false when the file cannot be opened or is empty.
+    bool open(const std::string& path, bool sequential = false) {
+        close();
+#if BLE_PROFILES_HAVE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        if (sequential) madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        data_ = static_cast<const uint8_t*>(p);
+        size_ = static_cast<size_t>(st.st_size);
+        mapped_ = true;
+        return true;
+#else
+        (void)sequential;
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) return false;
+        uint8_t buf[65536];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) copy_.insert(copy_.end(), buf, buf + n);
+        fclose(f);
+        if (copy_.empty()) return false;
+        data_ = copy_.data();
+        size_ = copy_.size();
+        return true;
+#endif
+    }
+
+    void close() {
+#if BLE_PROFILES_HAVE_MMAP
+        if (mapped_) munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+        mapped_ = false;
+        copy_.clear();
+    }
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    bool mapped_;
+    std::vector<uint8_t> copy_;
+};
+
+} // namespace BLEProfiles
@@ -0,0 +1,459 @@
+#pragma once
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring> // for memcpy
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+#include "BLEMappedFile.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Binary profile catalog
+// A versioned, little-endian serialization of many DeviceProfiles:
+//
+//   header   CATALOG_HEADER_SIZE bytes, see below
+//   profiles profileCount records, ascending unique company ID
+//   fields   fieldCount records; a profile owns [firstField, +fieldCount)
+//   strings  NUL-terminated UTF-8; records hold offsets, 0 is ""
+//
+// Header: magic u32, version u16, headerSize u16, profileRecordSize u16,
+// fieldRecordSize u16, profileCount u32, fieldCount u32, stringBytes u32,
+// profilesOffset u32, fieldsOffset u32, stringsOffset u32, reserved u32.
+// Readers accept larger headers and records than they know, so later
+// versions can append members without breaking older gateways.
+//
+// ProfileCatalogView validates a buffer once and compiles its field
+// records; it then reads and decodes straight from the tables, without
+// building DeviceProfiles.
+// -------------------------------------------------------------
+inline constexpr uint32_t CATALOG_MAGIC               = 0x43454C42;   // "BLEC"
+inline constexpr uint16_t CATALOG_VERSION             = 1;
+inline constexpr size_t   CATALOG_HEADER_SIZE         = 44;
+inline constexpr size_t   CATALOG_PROFILE_RECORD_SIZE = 24;
+inline constexpr size_t   CATALOG_FIELD_RECORD_SIZE   = 20;
+
+class ProfileCatalogView;
+
+// One field record
+class CatalogFieldView {
+public:
+    CatalogFieldView(const ProfileCatalogView& catalog, const uint8_t* record)
+        : catalog_(&catalog), p_(record) {}
+
+    std::string_view sensorName() const;
+    std::string_view unit() const;
+    uint16_t offset() const      { return loadUInt16(p_ + 12, false); }
+    DataType dataType() const    { return static_cast<DataType>(p_[14]); }
+    uint8_t bitOffset() const    { return p_[15]; }
+    uint8_t bitWidth() const     { return p_[16]; }
+    FieldEncoding encoding() const { return static_cast<FieldEncoding>(p_[17]); }
+
+    float scale() const {
+        uint32_t bits = loadUInt32(p_ + 8, false);
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    // nameId is left INVALID_SENSOR_NAME_ID; intern sensorName() when it is needed
+    CompiledField compiled() const {
+        return makeCompiledField(offset(), dataType(), scale(), bitOffset(), bitWidth(), INVALID_SENSOR_NAME_ID);
+    }
+
+private:
+    const ProfileCatalogView* catalog_;
+    const uint8_t* p_;
+};
+
+// One profile record
+class CatalogProfileView {
+public:
+    CatalogProfileView(const ProfileCatalogView& catalog, const uint8_t* record)
+        : catalog_(&catalog), p_(record) {}
+
+    uint16_t companyId() const   { return loadUInt16(p_, false); }
+    uint16_t totalLength() const { return loadUInt16(p_ + 2, false); }
+    size_t fieldCount() const    { return loadUInt16(p_ + 8, false); }
+
+    std::string_view profileName() const;
+    std::string_view deviceName() const;
+    std::string_view description() const;
+
+    CatalogFieldView field(size_t i) const;
+
+private:
+    friend class ProfileCatalogView;
+    uint32_t firstField() const { return loadUInt32(p_ + 4, false); }
+
+    const ProfileCatalogView* catalog_;
+    const uint8_t* p_;
+};
+
+class ProfileCatalogView {
+public:
+    ProfileCatalogView()
+        : profiles_(nullptr), fields_(nullptr), strings_(nullptr),
+          profileCount_(0), fieldCount_(0), stringBytes_(0), profileStride_(0), fieldStride_(0) {}
+
+    // Validate data as a catalog; returns false (and leaves the view empty)
+    // when it is truncated, from an unknown major version or inconsistent.
+    // The bytes must outlive the view.
+    bool open(const uint8_t* data, size_t size) {
+        *this = ProfileCatalogView();
+        if (!data || size < CATALOG_HEADER_SIZE) return false;
+        if (loadUInt32(data, false) != CATALOG_MAGIC) return false;
+        if (loadUInt16(data + 4, false) != CATALOG_VERSION) return false;
+
+        const size_t headerSize    = loadUInt16(data + 6, false);
+        const size_t profileStride = loadUInt16(data + 8, false);
+        const size_t fieldStride   = loadUInt16(data + 10, false);
+        const uint64_t profiles    = loadUInt32(data + 12, false);
+        const uint64_t fields      = loadUInt32(data + 16, false);
+        const uint64_t strings     = loadUInt32(data + 20, false);
+        const uint64_t profilesAt  = loadUInt32(data + 24, false);
+        const uint64_t fieldsAt    = loadUInt32(data + 28, false);
+        const uint64_t stringsAt   = loadUInt32(data + 32, false);
+
+        if (headerSize < CATALOG_HEADER_SIZE || headerSize > size) return false;
+        if (profileStride < CATALOG_PROFILE_RECORD_SIZE || fieldStride < CATALOG_FIELD_RECORD_SIZE) return false;
+        if (profilesAt + profiles * profileStride > size) return false;
+        if (fieldsAt + fields * fieldStride > size) return false;
+        if (strings == 0 || stringsAt + strings > size) return false;
+        if (data[stringsAt + strings - 1] != 0) return false;   // every string offset is NUL-bounded
+
+        ProfileCatalogView v;
+        v.profiles_ = data + profilesAt;
+        v.fields_ = data + fieldsAt;
+        v.strings_ = reinterpret_cast<const char*>(data + stringsAt);
+        v.profileCount_ = static_cast<size_t>(profiles);
+        v.fieldCount_ = static_cast<size_t>(fields);
+        v.stringBytes_ = static_cast<size_t>(strings);
+        v.profileStride_ = profileStride;
+        v.fieldStride_ = fieldStride;
+        if (!v.validateRecords()) return false;
+        v.compiled_.reserve(v.fieldCount_);
+        for (size_t i = 0; i < v.fieldCount_; ++i)
+            v.compiled_.push_back(CatalogFieldView(v, v.fieldRecord(i)).compiled());
+        *this = std::move(v);
+        return true;
+    }
+
+    bool empty() const { return profileCount_ == 0; }
+    size_t size() const { return profileCount_; }
+    size_t totalFieldCount() const { return fieldCount_; }
+
+    CatalogProfileView profile(size_t i) const { return CatalogProfileView(*this, profiles_ + i * profileStride_); }
+
+    // Index of the profile for companyId, or size() when absent (binary search)
+    size_t findProfile(uint16_t companyId) const {
+        size_t lo = 0, hi = profileCount_;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (loadUInt16(profiles_ + mid * profileStride_, false) < companyId) lo = mid + 1;
+            else hi = mid;
+        }
+        return (lo < profileCount_ && loadUInt16(profiles_ + lo * profileStride_, false) == companyId)
+            ? lo : profileCount_;
+    }
+
+    // Decode manufacturer data (company ID prefix included) with the matching
+    // profile's fields, in field order, into out (fieldCount() floats; fields
+    // past a short payload become NaN). Returns the number of fields decoded,
+    // 0 for unknown company IDs; *profileIndex receives the index or size().
+    size_t decode(const uint8_t* data, size_t len, float* out, size_t* profileIndex = nullptr) const {
+        size_t index = profileCount_;
+        size_t decoded = 0;
+        if (data && len >= 2) {
+            BLE_COUNT_CYCLES(PARSE_CALLS, PARSE_CYCLES);
+            uint16_t companyId = static_cast<uint16_t>(data[0] | (data[1] << 8));
+            index = findProfile(companyId);
+            if (index < profileCount_) {
+                BLE_COUNT_PACKETS(companyId, 1);
+                CatalogProfileView p = profile(index);
+                const CompiledField* fields = compiled_.data() + p.firstField();
+                const size_t payloadLen = len - 2;
+                for (size_t i = 0; i < p.fieldCount(); ++i) {
+                    const CompiledField& f = fields[i];
+                    if (static_cast<size_t>(f.offset) + f.size > payloadLen) {
+                        BLE_COUNT(FIELDS_OUT_OF_BOUNDS, 1);
+                        out[i] = std::numeric_limits<float>::quiet_NaN();
+                        continue;
+                    }
+                    out[i] = loadCompiledField(f, data + 2);
+                    ++decoded;
+                }
+            } else {
+                BLE_COUNT(UNKNOWN_COMPANY_IDS, 1);
+            }
+        }
+        if (profileIndex) *profileIndex = index;
+        return decoded;
+    }
+
+    // Materialise profile i, e.g. to build a ProfileRegistry from the catalog
+    DeviceProfile toDeviceProfile(size_t i) const {
+        CatalogProfileView p = profile(i);
+        DeviceProfile dp;
+        dp.profileName = std::string(p.profileName());
+        dp.deviceName = std::string(p.deviceName());
+        dp.manufacturerFormat = ManufacturerDataFormat(p.companyId(), std::string(p.description()));
+        dp.manufacturerFormat.totalLength = p.totalLength();
+        dp.manufacturerFormat.dataFields.reserve(p.fieldCount());
+        for (size_t k = 0; k < p.fieldCount(); ++k) {
+            CatalogFieldView f = p.field(k);
+            DataFieldConfig cfg(std::string(f.sensorName()), f.offset(), f.bitOffset(), f.bitWidth(),
+                                f.dataType(), f.scale(), std::string(f.unit()));
+            cfg.encoding = f.encoding();
+            dp.manufacturerFormat.dataFields.push_back(std::move(cfg));
+        }
+        return dp;
+    }
+
+    std::vector<DeviceProfile> toDeviceProfiles() const {
+        std::vector<DeviceProfile> out;
+        out.reserve(profileCount_);
+        for (size_t i = 0; i < profileCount_; ++i) out.push_back(toDeviceProfile(i));
+        return out;
+    }
+
+    // Internal accessors for the record views
+    std::string_view stringAt(uint32_t offset) const {
+        return offset < stringBytes_ ? std::string_view(strings_ + offset) : std::string_view();
+    }
+    const uint8_t* fieldRecord(size_t i) const { return fields_ + i * fieldStride_; }
+
+private:
+    bool validateRecords() const {
+        uint32_t previousId = 0;
+        for (size_t i = 0; i < profileCount_; ++i) {
+            const uint8_t* p = profiles_ + i * profileStride_;
+            uint32_t id = loadUInt16(p, false);
+            if (i > 0 && id <= previousId) return false;   // findProfile() relies on the order
+            previousId = id;
+            uint64_t first = loadUInt32(p + 4, false);
+            if (first + loadUInt16(p + 8, false) > fieldCount_) return false;
+            for (size_t s = 12; s < 24; s += 4)
+                if (loadUInt32(p + s, false) >= stringBytes_) return false;
+        }
+        for (size_t i = 0; i < fieldCount_; ++i) {
+            const uint8_t* f = fieldRecord(i);
+            if (loadUInt32(f, false) >= stringBytes_ || loadUInt32(f + 4, false) >= stringBytes_) return false;
+            if (f[14] > static_cast<uint8_t>(DataType::INT_BITS)) return false;
+            if (f[17] > static_cast<uint8_t>(FieldEncoding::DELTA_VARINT)) return false;
+            if (isBitFieldType(static_cast<DataType>(f[14])) && (f[15] > 7 || f[16] == 0 || f[16] > 32))
+                return false;
+        }
+        return true;
+    }
+
+    const uint8_t* profiles_;
+    const uint8_t* fields_;
+    const char* strings_;
+    size_t profileCount_;
+    size_t fieldCount_;
+    size_t stringBytes_;
+    size_t profileStride_;
+    size_t fieldStride_;
+    std::vector<CompiledField> compiled_;   // one per field record, built by open()
+};
+
+inline std::string_view CatalogFieldView::sensorName() const { return catalog_->stringAt(loadUInt32(p_, false)); }
+inline std::string_view CatalogFieldView::unit() const { return catalog_->stringAt(loadUInt32(p_ + 4, false)); }
+
+inline std::string_view CatalogProfileView::profileName() const { return catalog_->stringAt(loadUInt32(p_ + 12, false)); }
+inline std::string_view CatalogProfileView::deviceName() const { return catalog_->stringAt(loadUInt32(p_ + 16, false)); }
+inline std::string_view CatalogProfileView::description() const { return catalog_->stringAt(loadUInt32(p_ + 20, false)); }
+
+inline CatalogFieldView CatalogProfileView::field(size_t i) const {
+    return CatalogFieldView(*catalog_, catalog_->fieldRecord(firstField() + i));
+}
+
+// -------------------------------------------------------------
+// Catalog writer
+// Profiles are sorted by company ID; duplicates keep the first occurrence,
+// as in CompanyDispatchTable. Identical strings are stored once.
+// -------------------------------------------------------------
+inline std::vector<uint8_t> serializeProfileCatalog(const std::vector<DeviceProfile>& profiles) {
+    std::vector<const DeviceProfile*> sorted;
+    for (const auto& p : profiles) sorted.push_back(&p);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const DeviceProfile* a, const DeviceProfile* b) {
+        return a->manufacturerFormat.companyId < b->manufacturerFormat.companyId;
+    });
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), [](const DeviceProfile* a, const DeviceProfile* b) {
+        return a->manufacturerFormat.companyId == b->manufacturerFormat.companyId;
+    }), sorted.end());
+
+    std::vector<uint8_t> strings(1, 0);
+    std::map<std::string, uint32_t> stringOffsets{ { std::string(), 0 } };
+    auto intern = [&](const std::string& s) {
+        auto it = stringOffsets.find(s);
+        if (it != stringOffsets.end()) return it->second;
+        uint32_t at = static_cast<uint32_t>(strings.size());
+        strings.insert(strings.end(), s.begin(), s.end());
+        strings.push_back(0);
+        stringOffsets.emplace(s, at);
+        return at;
+    };
+
+    size_t fieldCount = 0;
+    for (const DeviceProfile* p : sorted) fieldCount += p->manufacturerFormat.dataFields.size();
+
+    const size_t profilesAt = CATALOG_HEADER_SIZE;
+    const size_t fieldsAt = profilesAt + sorted.size() * CATALOG_PROFILE_RECORD_SIZE;
+    const size_t stringsAt = fieldsAt + fieldCount * CATALOG_FIELD_RECORD_SIZE;
+    std::vector<uint8_t> out(stringsAt, 0);
+
+    uint32_t firstField = 0;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const ManufacturerDataFormat& fmt = sorted[i]->manufacturerFormat;
+        uint8_t* r = out.data() + profilesAt + i * CATALOG_PROFILE_RECORD_SIZE;
+        storeUInt16(r, fmt.companyId, false);
+        storeUInt16(r + 2, fmt.totalLength, false);
+        storeUInt32(r + 4, firstField, false);
+        storeUInt16(r + 8, static_cast<uint16_t>(fmt.dataFields.size()), false);
+        storeUInt32(r + 12, intern(sorted[i]->profileName), false);
+        storeUInt32(r + 16, intern(sorted[i]->deviceName), false);
+        storeUInt32(r + 20, intern(fmt.description), false);
+
+        for (const auto& f : fmt.dataFields) {
+            uint8_t* fr = out.data() + fieldsAt + firstField * CATALOG_FIELD_RECORD_SIZE;
+            uint32_t scaleBits;
+            memcpy(&scaleBits, &f.scale, sizeof(scaleBits));
+            storeUInt32(fr, intern(f.sensorName), false);
+            storeUInt32(fr + 4, intern(f.unit), false);
+            storeUInt32(fr + 8, scaleBits, false);
+            storeUInt16(fr + 12, f.offset, false);
+            fr[14] = static_cast<uint8_t>(f.dataType);
+            fr[15] = isBitFieldType(f.dataType) ? f.bitOffset : 0;
+            fr[16] = isBitFieldType(f.dataType) ? f.bitWidth : 0;
+            fr[17] = static_cast<uint8_t>(f.encoding);
+            ++firstField;
+        }
+    }
+
+    uint8_t* h = out.data();
+    storeUInt32(h, CATALOG_MAGIC, false);
+    storeUInt16(h + 4, CATALOG_VERSION, false);
+    storeUInt16(h + 6, static_cast<uint16_t>(CATALOG_HEADER_SIZE), false);
+    storeUInt16(h + 8, static_cast<uint16_t>(CATALOG_PROFILE_RECORD_SIZE), false);
+    storeUInt16(h + 10, static_cast<uint16_t>(CATALOG_FIELD_RECORD_SIZE), false);
+    storeUInt32(h + 12, static_cast<uint32_t>(sorted.size()), false);
+    storeUInt32(h + 16, static_cast<uint32_t>(fieldCount), false);
+    storeUInt32(h + 20, static_cast<uint32_t>(strings.size()), false);
+    storeUInt32(h + 24, static_cast<uint32_t>(profilesAt), false);
+    storeUInt32(h + 28, static_cast<uint32_t>(fieldsAt), false);
+    storeUInt32(h + 32, static_cast<uint32_t>(stringsAt), false);
+
+    out.insert(out.end(), strings.begin(), strings.end());
+    return out;
+}
+
+// Returns false when the file cannot be written
+inline bool writeProfileCatalog(const std::string& path, const std::vector<DeviceProfile>& profiles) {
+    std::vector<uint8_t> bytes = serializeProfileCatalog(profiles);
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    ok = (fclose(f) == 0) && ok;
+    return ok;
+}
+
+// -------------------------------------------------------------
+// Loaded catalog
+// Owns the catalog bytes (a read-only mapping where mmap is available,
+// otherwise a heap copy) and a validated view over them.
+// -------------------------------------------------------------
+class ProfileCatalog {
+public:
+    // nullptr when the file cannot be read or is not a valid catalog
+    static std::shared_ptr<const ProfileCatalog> load(const std::string& path) {
+        std::shared_ptr<ProfileCatalog> c(new ProfileCatalog());
+        if (!c->file_.open(path)) return nullptr;
+        if (!c->view_.open(c->file_.data(), c->file_.size())) return nullptr;
+        return c;
+    }
+
+    static std::shared_ptr<const ProfileCatalog> fromBytes(std::vector<uint8_t> bytes) {
+        std::shared_ptr<ProfileCatalog> c(new ProfileCatalog());
+        c->copy_ = std::move(bytes);
+        if (!c->view_.open(c->copy_.data(), c->copy_.size())) return nullptr;
+        return c;
+    }
+
+    ProfileCatalog(const ProfileCatalog&) = delete;
+    ProfileCatalog& operator=(const ProfileCatalog&) = delete;
+
+    const ProfileCatalogView& view() const { return view_; }
+    size_t byteSize() const { return file_.empty() ? copy_.size() : file_.size(); }
+
+private:
+    ProfileCatalog() {}
+
+    MappedFile file_;
+    std::vector<uint8_t> copy_;
+    ProfileCatalogView view_;
+};
+
+// -------------------------------------------------------------
+// Hot-swappable catalog slot
+// Readers take a snapshot and decode from it without holding the lock;
+// reload() validates the new file before publishing it, so a bad file
+// leaves the current catalog in place. A replaced catalog is unmapped
+// when its last snapshot is released.
+//
+//   ProfileCatalogSlot slot;
+//   slot.reload("/etc/ble/profiles.bin");
+//   auto cat = slot.current();
+//   if (cat) cat->view().decode(data, len, values);
+// -------------------------------------------------------------
+class ProfileCatalogSlot {
+public:
+    ProfileCatalogSlot() : generation_(0) {}
+
+    std::shared_ptr<const ProfileCatalog> current() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return catalog_;
+    }
+
+    // Returns false, keeping the current catalog, when path is not a valid catalog
+    bool reload(const std::string& path) {
+        std::shared_ptr<const ProfileCatalog> c = ProfileCatalog::load(path);
+        if (!c) return false;
+        publish(std::move(c));
+        return true;
+    }
+
+    void publish(std::shared_ptr<const ProfileCatalog> catalog) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            catalog_.swap(catalog);
+            ++generation_;
+        }
+        // catalog now holds the previous one; it is released here, outside the lock
+    }
+
+    // Incremented by every publish(); lets readers rebuild derived state lazily
+    uint64_t generation() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return generation_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::shared_ptr<const ProfileCatalog> catalog_;
+    uint64_t generation_;
+};
+
+} // namespace BLEProfiles
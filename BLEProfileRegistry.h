@@ -0,0 +1,117 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+#include "BLECompanyDispatch.h"
+#include "BLEProfileValidation.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Immutable profile registry
+// Owns its profiles and their compiled formats, and indexes them by
+// profile name, sensor group and company ID. Each profile is checked with
+// validateFormat() on the way in; invalid ones are left out and reported
+// by rejected(). Built once; afterwards every lookup is read-only, returns
+// references or pointers into the registry and never allocates, so
+// concurrent readers need no locking.
+//
+//   const auto& reg = getProfileRegistry();
+//   if (const DeviceProfile* p = reg.findByCompanyId(id)) ...
+// -------------------------------------------------------------
+struct RejectedProfile {
+    std::string profileName;
+    FormatValidation validation;
+};
+
+class ProfileRegistry {
+public:
+    explicit ProfileRegistry(std::vector<DeviceProfile> profiles) {
+        profiles_.reserve(profiles.size());
+        for (auto& p : profiles) {
+            FormatValidation v = validateFormat(p.manufacturerFormat);
+            if (v.ok()) profiles_.push_back(std::move(p));
+            else rejected_.push_back({ std::move(p.profileName), v });
+        }
+        for (size_t g = 0; g < KNOWN_GROUP_COUNT; ++g) byGroup_[g] = nullptr;
+
+        std::vector<CompanyDispatchEntry> entries;
+        entries.reserve(profiles_.size() + KNOWN_GROUP_COUNT);
+        for (const auto& p : profiles_) {
+            uint16_t id = p.manufacturerFormat.companyId;
+            SensorGroup group = lookupGroupForCompanyId(id);
+            entries.emplace_back(id, group, CompiledFormat(p.manufacturerFormat), &p);
+
+            byName_.emplace_back(std::string_view(p.profileName), &p);
+
+            size_t g = static_cast<size_t>(group);
+            if (g < KNOWN_GROUP_COUNT && !byGroup_[g]) byGroup_[g] = &p;
+        }
+        for (size_t g = 0; g < KNOWN_GROUP_COUNT; ++g)
+            entries.emplace_back(GROUP_COMPANY_ID_TABLE[g], static_cast<SensorGroup>(g));
+        dispatch_ = CompanyDispatchTable(entries);
+
+        std::stable_sort(byName_.begin(), byName_.end(),
+                         [](const NameIndex& a, const NameIndex& b) { return a.first < b.first; });
+    }
+
+    // Entries point into the registry, so it is neither copied nor moved
+    ProfileRegistry(const ProfileRegistry&) = delete;
+    ProfileRegistry& operator=(const ProfileRegistry&) = delete;
+
+    const std::vector<DeviceProfile>& profiles() const { return profiles_; }
+    size_t size() const { return profiles_.size(); }
+
+    // Profiles left out because validateFormat() found a problem
+    const std::vector<RejectedProfile>& rejected() const { return rejected_; }
+
+#if defined(__cpp_lib_span)
+    std::span<const DeviceProfile> view() const { return { profiles_.data(), profiles_.size() }; }
+#endif
+
+    const DeviceProfile* findByName(std::string_view profileName) const {
+        auto it = std::lower_bound(byName_.begin(), byName_.end(), profileName,
+                                   [](const NameIndex& e, std::string_view n) { return e.first < n; });
+        return (it != byName_.end() && it->first == profileName) ? it->second : nullptr;
+    }
+
+    const DeviceProfile* findByGroup(SensorGroup group) const {
+        size_t g = static_cast<size_t>(group);
+        return g < KNOWN_GROUP_COUNT ? byGroup_[g] : nullptr;
+    }
+
+    const DeviceProfile* findByCompanyId(uint16_t companyId) const {
+        const CompanyDispatchEntry* e = dispatch_.find(companyId);
+        return e ? e->profile : nullptr;
+    }
+
+    const CompiledFormat* compiledFormatFor(uint16_t companyId) const {
+        return dispatch_.formatFor(companyId);
+    }
+
+    const CompanyDispatchTable& dispatch() const { return dispatch_; }
+
+private:
+    using NameIndex = std::pair<std::string_view, const DeviceProfile*>;
+
+    std::vector<DeviceProfile> profiles_;
+    std::vector<RejectedProfile> rejected_;
+    std::vector<NameIndex> byName_;
+    const DeviceProfile* byGroup_[KNOWN_GROUP_COUNT];
+    CompanyDispatchTable dispatch_;
+};
+
+// Process-wide registry of the built-in profiles, constructed on first use
+inline const ProfileRegistry& getProfileRegistry() {
+    static const ProfileRegistry registry(getAllProfiles());
+    return registry;
+}
+
+} // namespace BLEProfiles
@@ -0,0 +1,143 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "BLEDeviceProfiles.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Format validation
+// Run once when a profile is registered, not per packet. A valid format
+// has every field inside totalLength, no two fields sharing a payload
+// bit, and sane bit-field layouts; the result also carries the payload
+// length that covers every field. A ManufacturerDataFormat stays
+// editable after validation, so parseManufacturerData() still checks
+// every field; CompiledFormat (e.g. ProfileRegistry::compiledFormatFor())
+// is the frozen form that checks the length once per packet.
+// -------------------------------------------------------------
+enum class FormatIssue : uint8_t {
+    NONE,
+    UNSUPPORTED_TYPE,    // dataType outside DataType
+    BAD_BIT_LAYOUT,      // bit field with bitOffset > 7, or bitWidth 0 or > 32
+    FIELD_PAST_END,      // offset + fieldByteSize() > totalLength
+    FIELDS_OVERLAP       // field shares payload bits with otherField
+};
+
+inline const char* formatIssueText(FormatIssue issue) {
+    switch (issue) {
+        case FormatIssue::NONE:             return "ok";
+        case FormatIssue::UNSUPPORTED_TYPE: return "unsupported data type";
+        case FormatIssue::BAD_BIT_LAYOUT:   return "bad bit-field layout";
+        case FormatIssue::FIELD_PAST_END:   return "field past totalLength";
+        case FormatIssue::FIELDS_OVERLAP:   return "fields overlap";
+    }
+    return "?";
+}
+
+struct FormatValidation {
+    FormatIssue issue;
+    size_t field;              // offending field (index into dataFields)
+    size_t otherField;         // FIELDS_OVERLAP: the field it overlaps
+    size_t minPayloadLength;   // payload bytes needed for every field to decode
+
+    bool ok() const { return issue == FormatIssue::NONE; }
+};
+
+// Payload bits [begin, end) a field occupies; bit k is bit k % 8 of byte k / 8,
+// matching loadBits()
+struct FieldBitRange {
+    size_t begin;
+    size_t end;
+    size_t field;
+};
+
+inline FieldBitRange fieldBitRange(const DataFieldConfig& f, size_t index) {
+    size_t begin = static_cast<size_t>(f.offset) * 8;
+    if (isBitFieldType(f.dataType)) return { begin + f.bitOffset, begin + f.bitOffset + f.bitWidth, index };
+    return { begin, begin + dataTypeSize(f.dataType) * 8, index };
+}
+
+// Reports the first problem found, checking fields in order
+inline FormatValidation validateFormat(const ManufacturerDataFormat& format) {
+    FormatValidation v = { FormatIssue::NONE, 0, 0, 0 };
+    const auto& fields = format.dataFields;
+
+    std::vector<FieldBitRange> ranges;
+    ranges.reserve(fields.size());
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const DataFieldConfig& f = fields[i];
+        if (static_cast<uint8_t>(f.dataType) > static_cast<uint8_t>(DataType::INT_BITS)) {
+            v.issue = FormatIssue::UNSUPPORTED_TYPE;
+            v.field = i;
+            return v;
+        }
+        if (isBitFieldType(f.dataType) && (f.bitOffset > 7 || f.bitWidth == 0 || f.bitWidth > 32)) {
+            v.issue = FormatIssue::BAD_BIT_LAYOUT;
+            v.field = i;
+            return v;
+        }
+        size_t end = static_cast<size_t>(f.offset) + fieldByteSize(f);
+        if (end > format.totalLength) {
+            v.issue = FormatIssue::FIELD_PAST_END;
+            v.field = i;
+            return v;
+        }
+        if (end > v.minPayloadLength) v.minPayloadLength = end;
+        ranges.push_back(fieldBitRange(f, i));
+    }
+
+    // Sorted by first bit, a field that overlaps any other overlaps its predecessor
+    std::sort(ranges.begin(), ranges.end(), [](const FieldBitRange& a, const FieldBitRange& b) {
+        return a.begin != b.begin ? a.begin < b.begin : a.field < b.field;
+    });
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        if (ranges[i].begin < ranges[i - 1].end) {
+            v.issue = FormatIssue::FIELDS_OVERLAP;
+            v.field = std::max(ranges[i].field, ranges[i - 1].field);
+            v.otherField = std::min(ranges[i].field, ranges[i - 1].field);
+            return v;
+        }
+    }
+    return v;
+}
+
+// -------------------------------------------------------------
+// Layout suggestion
+// The same fields (same order, so field ordinals do not change) with new
+// offsets: byte-aligned fields largest first, so every field starts at a
+// multiple of its size without padding, then the bit fields packed back
+// to back. totalLength shrinks to the space used. This changes the wire
+// layout, so it is meant for new profiles or a format version bump.
+// -------------------------------------------------------------
+inline ManufacturerDataFormat suggestFieldLayout(const ManufacturerDataFormat& format) {
+    ManufacturerDataFormat out = format;
+    auto& fields = out.dataFields;
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < fields.size(); ++i)
+        if (!isBitFieldType(fields[i].dataType)) order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return dataTypeSize(fields[a].dataType) > dataTypeSize(fields[b].dataType);
+    });
+
+    size_t offset = 0;
+    for (size_t i : order) {
+        fields[i].offset = static_cast<uint16_t>(offset);
+        offset += dataTypeSize(fields[i].dataType);
+    }
+
+    size_t bit = offset * 8;
+    for (auto& f : fields) {
+        if (!isBitFieldType(f.dataType)) continue;
+        f.offset = static_cast<uint16_t>(bit / 8);
+        f.bitOffset = static_cast<uint8_t>(bit % 8);
+        bit += f.bitWidth;
+    }
+    out.totalLength = static_cast<uint16_t>((bit + 7) / 8);
+    return out;
+}
+
+} // namespace BLEProfiles
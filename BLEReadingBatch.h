@@ -0,0 +1,122 @@
+#pragma once
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+#include "BLEBatchDecode.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Columnar reading batch (struct of arrays)
+// One contiguous float column per format field plus device address
+// and timestamp columns, all of size(). Row r of every column belongs
+// to the same advert; fields missing from a short advert are NaN.
+//
+//   ReadingBatch batch(compiled);
+//   batch.append(addr, nowUs, data, len);               // per advert
+//   batch.append(addrs, times, packets, lengths, n);    // per scan burst
+//   const float* t = batch.column(batch.columnIndex(tempId));
+// -------------------------------------------------------------
+class ReadingBatch {
+public:
+    explicit ReadingBatch(const CompiledFormat& format)
+        : format_(format), columns_(format.fieldCount()) {}
+
+    explicit ReadingBatch(const ManufacturerDataFormat& format)
+        : ReadingBatch(CompiledFormat(format)) {}
+
+    size_t size() const { return devices_.size(); }
+    bool empty() const { return devices_.empty(); }
+
+    size_t columnCount() const { return columns_.size(); }
+
+    // Column of the field with the given interned name, or columnCount() when absent
+    size_t columnIndex(SensorNameId id) const { return format_.indexOf(id); }
+
+    SensorNameId columnNameId(size_t column) const { return format_.fields[column].nameId; }
+
+    const float* column(size_t i) const { return columns_[i].data(); }
+    const DeviceAddress* devices() const { return devices_.data(); }
+    const uint64_t* timestamps() const { return timestamps_.data(); }
+
+    const CompiledFormat& format() const { return format_; }
+
+    void reserve(size_t rows) {
+        for (auto& c : columns_) c.reserve(rows);
+        devices_.reserve(rows);
+        timestamps_.reserve(rows);
+    }
+
+    // Drops the rows but keeps the capacity, so a reused batch stops allocating
+    void clear() {
+        for (auto& c : columns_) c.clear();
+        devices_.clear();
+        timestamps_.clear();
+    }
+
+    // Decode one advert (company ID prefix included) straight into the columns.
+    // Returns the number of fields decoded; the row is appended even when 0.
+    size_t append(DeviceAddress device, uint64_t timestamp, const uint8_t* data, size_t len) {
+        size_t row = grow(1);
+        devices_[row] = device;
+        timestamps_[row] = timestamp;
+
+        const size_t payloadLen = (data && len >= 2) ? len - 2 : 0;
+        size_t decoded = 0;
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            const CompiledField& f = format_.fields[i];
+            if (payloadLen == 0 || static_cast<size_t>(f.offset) + f.size > payloadLen) {
+                columns_[i][row] = std::numeric_limits<float>::quiet_NaN();
+                continue;
+            }
+            columns_[i][row] = loadCompiledField(f, data + 2);
+            ++decoded;
+        }
+        return decoded;
+    }
+
+    // Decode count adverts with the column-wise batch decoder.
+    // Returns the number of adverts that decoded every field.
+    size_t append(const DeviceAddress* devices, const uint64_t* timestamps,
+                  const uint8_t* const* packets, const size_t* lengths, size_t count) {
+        if (count == 0) return 0;
+        size_t row = grow(count);
+        for (size_t r = 0; r < count; ++r) {
+            devices_[row + r] = devices[r];
+            timestamps_[row + r] = timestamps[r];
+        }
+        columnPtrs_.resize(columns_.size());
+        for (size_t i = 0; i < columns_.size(); ++i) columnPtrs_[i] = columns_[i].data() + row;
+        return decodeBatch(format_, packets, lengths, count, columnPtrs_.data());
+    }
+
+    // Append already decoded values (columnCount() floats, e.g. from DeviceStateCache)
+    void appendValues(DeviceAddress device, uint64_t timestamp, const float* values) {
+        size_t row = grow(1);
+        devices_[row] = device;
+        timestamps_[row] = timestamp;
+        for (size_t i = 0; i < columns_.size(); ++i) columns_[i][row] = values[i];
+    }
+
+private:
+    // Adds n rows to every column, returns the first new row
+    size_t grow(size_t n) {
+        size_t row = devices_.size();
+        for (auto& c : columns_) c.resize(row + n);
+        devices_.resize(row + n);
+        timestamps_.resize(row + n);
+        return row;
+    }
+
+    CompiledFormat format_;
+    std::vector<std::vector<float>> columns_;
+    std::vector<DeviceAddress> devices_;
+    std::vector<uint64_t> timestamps_;
+    std::vector<float*> columnPtrs_;
+};
+
+} // namespace BLEProfiles
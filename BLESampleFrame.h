@@ -0,0 +1,233 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring> // for memset
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Multi-sample frames (streaming mode)
+// A frame carries K repeated sample records after a small header:
+//
+//   [company ID:2][base timestamp ms, UINT16_LE:2][interval us, UINT16_LE:2]
+//   [sample 0][sample 1]...[sample K-1]
+//
+// K is implied by the length: (payloadLen - header) / record length.
+// Sample k was taken at baseTimestamp * 1000 + k * interval microseconds.
+// The 16-bit millisecond base wraps every 65536 ms: decode() without a
+// SampleClock reports timestamps modulo that period; pass the device's
+// SampleClock to get a continuous 64-bit timeline instead:
+//
+//   std::unordered_map<DeviceAddress, SampleClock> clocks;
+//   size_t n = frame.decode(data, len, samples, timestampsUs, clocks[address]);
+//
+// Record fields use offsets relative to the start of each record.
+// -------------------------------------------------------------
+inline constexpr size_t SAMPLE_FRAME_HEADER_LENGTH = 4;
+
+struct SampleFrameFormat {
+    uint16_t companyId;
+    ManufacturerDataFormat record;   // one sample; record.totalLength is the record stride
+    uint8_t maxSamples;
+    std::string description;
+
+    SampleFrameFormat() : companyId(0), maxSamples(0) {}
+    SampleFrameFormat(uint16_t id, const ManufacturerDataFormat& rec, uint8_t maxK, const std::string& desc)
+        : companyId(id), record(rec), maxSamples(maxK), description(desc) {}
+
+    // Manufacturer data length (company ID included) of a frame with n samples
+    size_t frameLength(size_t n) const {
+        return 2 + SAMPLE_FRAME_HEADER_LENGTH + n * record.totalLength;
+    }
+};
+
+struct SampleFrameHeader {
+    uint16_t baseTimestampMs;
+    uint16_t intervalUs;
+};
+
+// -------------------------------------------------------------
+// Per-device unwrapper for the 16-bit millisecond base
+// Counts wraps from successive bases: a backward step of at least half
+// the period is a wrap, a smaller one a late or repeated frame that is
+// placed in the current epoch (or the previous one across a wrap)
+// without moving the clock. Frames must arrive less than 32768 ms apart.
+// -------------------------------------------------------------
+struct SampleClock {
+    uint64_t epochs;       // completed 65536 ms periods
+    uint16_t lastBaseMs;
+    bool started;
+
+    SampleClock() : epochs(0), lastBaseMs(0), started(false) {}
+
+    // Continuous milliseconds for baseMs; the first frame starts epoch 0
+    uint64_t unwrapMs(uint16_t baseMs) {
+        if (!started) {
+            started = true;
+            lastBaseMs = baseMs;
+            return baseMs;
+        }
+        uint16_t ahead = static_cast<uint16_t>(baseMs - lastBaseMs);
+        if (ahead < 0x8000) {
+            if (baseMs < lastBaseMs) ++epochs;
+            lastBaseMs = baseMs;
+            return (epochs << 16) | baseMs;
+        }
+        // Late frame: it belongs to the previous epoch if it predates a wrap
+        uint64_t epoch = (baseMs > lastBaseMs && epochs > 0) ? epochs - 1 : epochs;
+        return (epoch << 16) | baseMs;
+    }
+
+    void reset() { *this = SampleClock(); }
+};
+
+// -------------------------------------------------------------
+// Motion streaming frame: 6-axis IMU records, up to 20 per extended advert
+// -------------------------------------------------------------
+inline SampleFrameFormat createMotionStreamFormat() {
+    ManufacturerDataFormat rec(COMPANY_ID_MOTION, "Motion sample record");
+    rec.dataFields = {
+        {"AccelX",  0, DataType::INT16_LE, 0.001f, "g"},
+        {"AccelY",  2, DataType::INT16_LE, 0.001f, "g"},
+        {"AccelZ",  4, DataType::INT16_LE, 0.001f, "g"},
+        {"GyroX",   6, DataType::INT16_LE, 0.1f,   "°/s"},
+        {"GyroY",   8, DataType::INT16_LE, 0.1f,   "°/s"},
+        {"GyroZ",  10, DataType::INT16_LE, 0.1f,   "°/s"}
+    };
+    rec.totalLength = 12;
+    return SampleFrameFormat(COMPANY_ID_MOTION, rec, 20, "Motion streaming frame");
+}
+
+// -------------------------------------------------------------
+// Compiled frame codec
+// Samples are exchanged as one contiguous row-major buffer:
+// samples[k * fieldCount() + i] is field i of sample k.
+// -------------------------------------------------------------
+struct CompiledSampleFrame {
+    uint16_t companyId;
+    uint8_t maxSamples;
+    size_t recordLength;
+    CompiledFormat record;
+
+    CompiledSampleFrame() : companyId(0), maxSamples(0), recordLength(0) {}
+
+    explicit CompiledSampleFrame(const SampleFrameFormat& format)
+        : companyId(format.companyId), maxSamples(format.maxSamples),
+          recordLength(format.record.totalLength), record(format.record) {}
+
+    size_t fieldCount() const { return record.fieldCount(); }
+
+    // Number of samples a frame of len bytes (company ID included) carries,
+    // capped at maxSamples; 0 when the length is not a valid frame length.
+    size_t sampleCountFor(size_t len) const {
+        if (recordLength == 0 || len < 2 + SAMPLE_FRAME_HEADER_LENGTH) return 0;
+        size_t body = len - 2 - SAMPLE_FRAME_HEADER_LENGTH;
+        if (body % recordLength != 0) return 0;
+        size_t n = body / recordLength;
+        return n <= maxSamples ? n : 0;
+    }
+
+    // Decode a frame into samples (room for maxSamples * fieldCount() floats)
+    // and, when non-null, per-sample timestamps in microseconds.
+    // Returns the sample count, 0 for malformed frames.
+    size_t decode(const uint8_t* data, size_t len, float* samples,
+                  uint64_t* timestampsUs = nullptr, SampleFrameHeader* header = nullptr) const
+    {
+        size_t n = data ? sampleCountFor(len) : 0;
+        if (n == 0 || record.minPayloadLength > recordLength) return 0;
+
+        SampleFrameHeader h;
+        h.baseTimestampMs = loadUInt16(data + 2, false);
+        h.intervalUs      = loadUInt16(data + 4, false);
+        if (header) *header = h;
+
+        const uint8_t* rec = data + 2 + SAMPLE_FRAME_HEADER_LENGTH;
+        const size_t stride = fieldCount();
+        for (size_t k = 0; k < n; ++k, rec += recordLength) {
+            float* row = samples + k * stride;
+            for (size_t i = 0; i < stride; ++i) {
+                const CompiledField& f = record.fields[i];
+                row[i] = loadCompiledField(f, rec);
+            }
+        }
+
+        if (timestampsUs) {
+            uint64_t base = static_cast<uint64_t>(h.baseTimestampMs) * 1000;
+            for (size_t k = 0; k < n; ++k) timestampsUs[k] = base + k * h.intervalUs;
+        }
+        return n;
+    }
+
+    // As above, with timestamps on the continuous timeline kept by clock.
+    // Malformed frames leave the clock untouched.
+    size_t decode(const uint8_t* data, size_t len, float* samples,
+                  uint64_t* timestampsUs, SampleClock& clock) const
+    {
+        SampleFrameHeader h;
+        size_t n = decode(data, len, samples, nullptr, &h);
+        if (n == 0) return 0;
+        uint64_t base = clock.unwrapMs(h.baseTimestampMs) * 1000;
+        if (timestampsUs) {
+            for (size_t k = 0; k < n; ++k) timestampsUs[k] = base + k * h.intervalUs;
+        }
+        return n;
+    }
+
+    // Encode n samples (row-major, NaN leaves a field zero) into out.
+    // Returns bytes written, or 0 when n is 0 or exceeds maxSamples, or
+    // capacity is too small.
+    size_t encode(const float* samples, size_t n, const SampleFrameHeader& header,
+                  uint8_t* out, size_t capacity) const
+    {
+        size_t len = 2 + SAMPLE_FRAME_HEADER_LENGTH + n * recordLength;
+        if (!out || n == 0 || n > maxSamples || capacity < len || record.minPayloadLength > recordLength) return 0;
+
+        memset(out, 0, len);
+        out[0] = static_cast<uint8_t>(companyId & 0xFF);
+        out[1] = static_cast<uint8_t>((companyId >> 8) & 0xFF);
+        storeUInt16(out + 2, header.baseTimestampMs, false);
+        storeUInt16(out + 4, header.intervalUs, false);
+
+        uint8_t* rec = out + 2 + SAMPLE_FRAME_HEADER_LENGTH;
+        const size_t stride = fieldCount();
+        for (size_t k = 0; k < n; ++k, rec += recordLength) {
+            const float* row = samples + k * stride;
+            for (size_t i = 0; i < stride; ++i) {
+                if (row[i] != row[i]) continue; // NaN: no value for this field
+                storeCompiledField(record.fields[i], rec, row[i]);
+            }
+        }
+        return len;
+    }
+};
+
+// -------------------------------------------------------------
+// Convenience wrappers compiling the frame format per call
+// -------------------------------------------------------------
+inline size_t packSampleFrame(
+    const float* samples,
+    size_t n,
+    const SampleFrameHeader& header,
+    const SampleFrameFormat& format,
+    uint8_t* out,
+    size_t capacity)
+{
+    return CompiledSampleFrame(format).encode(samples, n, header, out, capacity);
+}
+
+inline size_t parseSampleFrame(
+    const uint8_t* data,
+    size_t len,
+    const SampleFrameFormat& format,
+    float* samples,
+    uint64_t* timestampsUs = nullptr,
+    SampleFrameHeader* header = nullptr)
+{
+    return CompiledSampleFrame(format).decode(data, len, samples, timestampsUs, header);
+}
+
+} // namespace BLEProfiles
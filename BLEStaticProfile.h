@@ -0,0 +1,169 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <cstring> // for memset
+
+#include "BLEDeviceProfiles.h"
+#include "BLECompiledFormat.h"
+
+namespace BLEProfiles {
+
+// -------------------------------------------------------------
+// Type-level field codecs, resolved entirely at compile time
+// -------------------------------------------------------------
+template <DataType T>
+inline float decodeAs(const uint8_t* p) {
+    if constexpr (T == DataType::UINT8)          return decodeUInt8(p);
+    else if constexpr (T == DataType::INT8)      return decodeInt8(p);
+    else if constexpr (T == DataType::UINT16_LE) return decodeUInt16LE(p);
+    else if constexpr (T == DataType::UINT16_BE) return decodeUInt16BE(p);
+    else if constexpr (T == DataType::INT16_LE)  return decodeInt16LE(p);
+    else if constexpr (T == DataType::INT16_BE)  return decodeInt16BE(p);
+    else if constexpr (T == DataType::UINT32_LE) return decodeUInt32LE(p);
+    else if constexpr (T == DataType::UINT32_BE) return decodeUInt32BE(p);
+    else if constexpr (T == DataType::FLOAT_LE)  return decodeFloatLE(p);
+    else if constexpr (T == DataType::FLOAT_BE)  return decodeFloatBE(p);
+    else                                         return decodeUnsupported(p);
+}
+
+template <DataType T>
+inline void encodeAs(uint8_t* p, float val) {
+    if constexpr (T == DataType::UINT8)          encodeUInt8(p, val);
+    else if constexpr (T == DataType::INT8)      encodeInt8(p, val);
+    else if constexpr (T == DataType::UINT16_LE) encodeUInt16LE(p, val);
+    else if constexpr (T == DataType::UINT16_BE) encodeUInt16BE(p, val);
+    else if constexpr (T == DataType::INT16_LE)  encodeInt16LE(p, val);
+    else if constexpr (T == DataType::INT16_BE)  encodeInt16BE(p, val);
+    else if constexpr (T == DataType::UINT32_LE) encodeUInt32LE(p, val);
+    else if constexpr (T == DataType::UINT32_BE) encodeUInt32BE(p, val);
+    else if constexpr (T == DataType::FLOAT_LE)  encodeFloatLE(p, val);
+    else if constexpr (T == DataType::FLOAT_BE)  encodeFloatBE(p, val);
+    else                                         encodeUnsupported(p, val);
+}
+
+constexpr size_t staticDataTypeSize(DataType dt) {
+    return (dt == DataType::UINT8 || dt == DataType::INT8) ? 1
+         : (dt == DataType::UINT16_LE || dt == DataType::UINT16_BE ||
+            dt == DataType::INT16_LE  || dt == DataType::INT16_BE) ? 2
+         : 4;
+}
+
+constexpr size_t staticFieldByteSize(const StaticField& f) {
+    return isBitFieldType(f.dataType) ? bitFieldByteSpan(f.bitOffset, f.bitWidth)
+                                      : staticDataTypeSize(f.dataType);
+}
+
+constexpr bool staticNameEquals(const char* a, const char* b) {
+    while (*a && *a == *b) { ++a; ++b; }
+    return *a == *b;
+}
+
+// -------------------------------------------------------------
+// Statically specialized profile
+// Def is a profile definition struct (see EnvironmentalProfileDef).
+// parse()/pack() expand to one load/store per field with constant
+// offsets and scales; there are no loops, switches or strings.
+//
+//   using Env = StaticProfile<EnvironmentalProfileDef>;
+//   Env::Values v;
+//   if (Env::parse(data, len, v)) use(v[Env::indexOf("Temperature")]);
+// -------------------------------------------------------------
+template <typename Def>
+struct StaticProfile {
+    static constexpr size_t fieldCount = sizeof(Def::fields) / sizeof(Def::fields[0]);
+
+    // Plain output struct, indexed by field ordinal
+    using Values = std::array<float, fieldCount>;
+
+    static constexpr uint16_t companyId = Def::companyId;
+    static constexpr size_t packedLength = 2 + static_cast<size_t>(Def::totalLength);
+
+    static constexpr size_t computeMinPayloadLength() {
+        size_t end = 0;
+        for (size_t i = 0; i < fieldCount; ++i) {
+            size_t e = Def::fields[i].offset + staticFieldByteSize(Def::fields[i]);
+            if (e > end) end = e;
+        }
+        return end;
+    }
+
+    static constexpr size_t minPayloadLength = computeMinPayloadLength();
+    static_assert(minPayloadLength <= Def::totalLength, "profile field exceeds totalLength");
+
+    // Ordinal of a field by name, or fieldCount when absent; usable in constant expressions
+    static constexpr size_t indexOf(const char* name) {
+        for (size_t i = 0; i < fieldCount; ++i)
+            if (staticNameEquals(Def::fields[i].sensorName, name)) return i;
+        return fieldCount;
+    }
+
+    // Parse manufacturer data (including the 2-byte company ID prefix).
+    // Returns false without touching out when the payload is too short.
+    static bool parse(const uint8_t* data, size_t len, Values& out) {
+        if (!data || len < 2 + minPayloadLength) return false;
+        parseFields(data + 2, out, std::make_index_sequence<fieldCount>{});
+        return true;
+    }
+
+    // Pack values into out (company ID prefix + totalLength bytes); NaN
+    // values are missing and leave their field zero.
+    // Returns bytes written, or 0 when capacity is too small.
+    static size_t pack(const Values& values, uint8_t* out, size_t capacity) {
+        if (!out || capacity < packedLength) return 0;
+        memset(out, 0, packedLength);
+        out[0] = static_cast<uint8_t>(companyId & 0xFF);
+        out[1] = static_cast<uint8_t>((companyId >> 8) & 0xFF);
+        packFields(values, out + 2, std::make_index_sequence<fieldCount>{});
+        return packedLength;
+    }
+
+    // Runtime view for getAllProfiles() and the map-based API
+    static DeviceProfile toDeviceProfile() { return makeDeviceProfile<Def>(); }
+
+private:
+    static constexpr float effectiveScale(size_t i) {
+        return Def::fields[i].scale != 0.0f ? Def::fields[i].scale : 1.0f;
+    }
+
+    // Raw (unscaled) value of field I; bit fields fold to a constant shift and mask
+    template <size_t I>
+    static float decodeField(const uint8_t* payload) {
+        constexpr StaticField f = Def::fields[I];
+        if constexpr (isBitFieldType(f.dataType))
+            return bitsToFloat(loadBits(payload + f.offset, f.bitOffset, f.bitWidth), f.bitWidth,
+                               f.dataType == DataType::INT_BITS);
+        else
+            return decodeAs<f.dataType>(payload + f.offset);
+    }
+
+    template <size_t I>
+    static void encodeField(uint8_t* payload, float raw) {
+        constexpr StaticField f = Def::fields[I];
+        if constexpr (isBitFieldType(f.dataType))
+            storeBits(payload + f.offset, f.bitOffset, f.bitWidth,
+                      floatToBits(raw, f.bitWidth, f.dataType == DataType::INT_BITS));
+        else
+            encodeAs<f.dataType>(payload + f.offset, raw);
+    }
+
+    template <size_t... I>
+    static void parseFields(const uint8_t* payload, Values& out, std::index_sequence<I...>) {
+        ((out[I] = decodeField<I>(payload) * effectiveScale(I)), ...);
+    }
+
+    template <size_t... I>
+    static void packFields(const Values& values, uint8_t* payload, std::index_sequence<I...>) {
+        ((values[I] == values[I] ? encodeField<I>(payload, values[I] * (1.0f / effectiveScale(I))) : void()), ...);
+    }
+};
+
+using EnvironmentalStaticProfile = StaticProfile<EnvironmentalProfileDef>;
+using AirQualityStaticProfile    = StaticProfile<AirQualityProfileDef>;
+using MotionStaticProfile        = StaticProfile<MotionProfileDef>;
+using AmbientStaticProfile       = StaticProfile<AmbientProfileDef>;
+using SystemStaticProfile        = StaticProfile<SystemProfileDef>;
+using CurrentStaticProfile       = StaticProfile<CurrentProfileDef>;
+
+} // namespace BLEProfiles
@@ -0,0 +1,579 @@
+// Google Benchmark suite for the pack/parse/lookup paths.
+//
+//   g++ -std=c++17 -O2 -I.. BLEProfilesBenchmark.cpp -lbenchmark -lpthread -o ble_bench
+//   ./ble_bench --benchmark_filter=Parse
+//
+// Every case is registered once per profile returned by getAllProfiles().
+// Counters: time/packet, allocs/packet and bytes_per_second (manufacturer data bytes).
+// DeviceCache/<profile>/<n> replays adverts where n% repeat the device's previous payload.
+// CatalogOpen/<n> validates a serialized catalog of n profiles.
+// Fingerprint classifies foreign adverts (random length 0-26) against the built-in formats.
+//
+// Regression check against a stored baseline (see "Baseline comparison" below):
+//   ./ble_bench --benchmark_repetitions=5 --save-baseline=baseline.txt
+//   ./ble_bench --benchmark_repetitions=5 --baseline=baseline.txt --max-regression=10
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <map>
+#include <memory_resource>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../BLEDeviceProfiles.h"
+#include "../BLECompiledFormat.h"
+#include "../BLEFixedPoint.h"
+#include "../BLEBatchDecode.h"
+#include "../BLECompanyDispatch.h"
+#include "../BLEDeviceCache.h"
+#include "../BLEAggregate.h"
+#include "../BLEProfileCatalog.h"
+#include "../BLEFormatFingerprint.h"
+#include "../BLEStaticProfile.h"
+#include "../BLEIngestPipeline.h"
+
+// -------------------------------------------------------------
+// Global allocation counter
+// -------------------------------------------------------------
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"  // malloc/free pairing is intentional
+#endif
+
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace BLEProfiles;
+
+namespace {
+
+// -------------------------------------------------------------
+// Synthetic payloads
+// -------------------------------------------------------------
+std::vector<uint8_t> makePackets(const ManufacturerDataFormat& format, size_t count, uint32_t seed = 1) {
+    size_t len = 2 + format.totalLength;
+    std::vector<uint8_t> buf(len * count);
+    std::mt19937 rng(seed);
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t* p = &buf[i * len];
+        p[0] = static_cast<uint8_t>(format.companyId & 0xFF);
+        p[1] = static_cast<uint8_t>(format.companyId >> 8);
+        for (size_t b = 2; b < len; ++b) p[b] = static_cast<uint8_t>(rng());
+    }
+    return buf;
+}
+
+std::map<std::string, float> makeValueMap(const ManufacturerDataFormat& format) {
+    auto pkt = makePackets(format, 1);
+    return parseManufacturerData(pkt.data(), pkt.size(), format);
+}
+
+struct AllocScope {
+    uint64_t start = g_allocations.load(std::memory_order_relaxed);
+    uint64_t count() const { return g_allocations.load(std::memory_order_relaxed) - start; }
+};
+
+void report(benchmark::State& state, uint64_t allocs, size_t packetBytes, size_t packetsPerIteration) {
+    int64_t packets = state.iterations() * static_cast<int64_t>(packetsPerIteration);
+    state.SetItemsProcessed(packets);
+    state.SetBytesProcessed(packets * static_cast<int64_t>(packetBytes));
+    // Inverted rate: seconds per packet, printed with an SI prefix (e.g. 14.3n)
+    state.counters["time/packet"] = benchmark::Counter(
+        static_cast<double>(packets), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["allocs/packet"] = packets ? static_cast<double>(allocs) / packets : 0.0;
+}
+
+// -------------------------------------------------------------
+// Single-packet cases
+// -------------------------------------------------------------
+void BM_PackMap(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    auto values = makeValueMap(format);
+    AllocScope allocs;
+    for (auto _ : state) {
+        auto data = packManufacturerData(values, format);
+        benchmark::DoNotOptimize(data.data());
+    }
+    report(state, allocs.count(), 2 + format.totalLength, 1);
+}
+
+void BM_PackInPlace(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    CompiledFormat compiled(format);
+    auto pkt = makePackets(format, 1);
+    std::vector<float> values(compiled.fieldCount());
+    compiled.decode(pkt.data(), pkt.size(), values.data());
+    std::vector<uint8_t> out(pkt.size());
+    AllocScope allocs;
+    for (auto _ : state) {
+        size_t n = compiled.encode(values.data(), out.data(), out.size());
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    report(state, allocs.count(), pkt.size(), 1);
+}
+
+void BM_ParseMap(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    auto pkt = makePackets(format, 1);
+    AllocScope allocs;
+    for (auto _ : state) {
+        auto values = parseManufacturerData(pkt.data(), pkt.size(), format);
+        benchmark::DoNotOptimize(values);
+    }
+    report(state, allocs.count(), pkt.size(), 1);
+}
+
+// Arena-backed map parse; the arena is released once per 1024 packets (one scan window)
+void BM_ParseArena(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    auto pkt = makePackets(format, 1);
+    std::pmr::monotonic_buffer_resource arena(256 * 1024);
+    size_t inWindow = 0;
+    AllocScope allocs;
+    for (auto _ : state) {
+        {
+            auto values = parseManufacturerData(pkt.data(), pkt.size(), format, &arena);
+            benchmark::DoNotOptimize(values);
+        }
+        if (++inWindow == 1024) { arena.release(); inWindow = 0; }
+    }
+    report(state, allocs.count(), pkt.size(), 1);
+}
+
+void BM_ParseCompiled(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    CompiledFormat compiled(format);
+    auto pkt = makePackets(format, 1);
+    std::vector<float> out(compiled.fieldCount());
+    AllocScope allocs;
+    for (auto _ : state) {
+        size_t n = compiled.decode(pkt.data(), pkt.size(), out.data());
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    report(state, allocs.count(), pkt.size(), 1);
+}
+
+void BM_ParseFixed(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    FixedPointFormat fixed(format);
+    auto pkt = makePackets(format, 1);
+    std::vector<int64_t> out(fixed.fieldCount());
+    AllocScope allocs;
+    for (auto _ : state) {
+        size_t n = fixed.decode(pkt.data(), pkt.size(), out.data());
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    report(state, allocs.count(), pkt.size(), 1);
+}
+
+void BM_ParseReadings(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    auto pkt = makePackets(format, 1);
+    std::vector<SensorReading> out(format.dataFields.size());
+    AllocScope allocs;
+    for (auto _ : state) {
+        size_t n = parseManufacturerData(pkt.data(), pkt.size(), format, out.data(), out.size());
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    report(state, allocs.count(), pkt.size(), 1);
+}
+
+template <typename Def>
+void BM_ParseStatic(benchmark::State& state) {
+    using Profile = StaticProfile<Def>;
+    auto pkt = makePackets(Profile::toDeviceProfile().manufacturerFormat, 1);
+    typename Profile::Values out;
+    AllocScope allocs;
+    for (auto _ : state) {
+        bool ok = Profile::parse(pkt.data(), pkt.size(), out);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(out);
+        benchmark::ClobberMemory();
+    }
+    report(state, allocs.count(), pkt.size(), 1);
+}
+
+void BM_LookupAndDecode(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    CompanyDispatchTable table = buildDispatchTable();
+    auto pkt = makePackets(format, 1);
+    std::vector<float> out(format.dataFields.size());
+    AllocScope allocs;
+    for (auto _ : state) {
+        size_t n = table.decode(pkt.data(), pkt.size(), out.data());
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    report(state, allocs.count(), pkt.size(), 1);
+}
+
+// -------------------------------------------------------------
+// Burst cases; state.range(0) is the number of packets per burst
+// -------------------------------------------------------------
+void BM_BurstParseMap(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    size_t count = static_cast<size_t>(state.range(0));
+    size_t len = 2 + format.totalLength;
+    auto buf = makePackets(format, count);
+    AllocScope allocs;
+    for (auto _ : state) {
+        for (size_t i = 0; i < count; ++i) {
+            auto values = parseManufacturerData(&buf[i * len], len, format);
+            benchmark::DoNotOptimize(values);
+        }
+    }
+    report(state, allocs.count(), len, count);
+}
+
+void BM_BurstCompiled(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    CompiledFormat compiled(format);
+    size_t count = static_cast<size_t>(state.range(0));
+    size_t len = 2 + format.totalLength;
+    auto buf = makePackets(format, count);
+    std::vector<float> out(compiled.fieldCount());
+    AllocScope allocs;
+    for (auto _ : state) {
+        for (size_t i = 0; i < count; ++i)
+            benchmark::DoNotOptimize(compiled.decode(&buf[i * len], len, out.data()));
+        benchmark::ClobberMemory();
+    }
+    report(state, allocs.count(), len, count);
+}
+
+void BM_BurstBatch(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    CompiledFormat compiled(format);
+    size_t count = static_cast<size_t>(state.range(0));
+    size_t len = 2 + format.totalLength;
+    auto buf = makePackets(format, count);
+    std::vector<std::vector<float>> columns(compiled.fieldCount(), std::vector<float>(count));
+    std::vector<float*> columnPtrs;
+    for (auto& c : columns) columnPtrs.push_back(c.data());
+    AllocScope allocs;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(decodeBatch(compiled, buf.data(), len, count, columnPtrs.data()));
+        benchmark::ClobberMemory();
+    }
+    report(state, allocs.count(), len, count);
+}
+
+// Per-device cache over 50k devices; state.range(0) is the percentage of
+// adverts repeating the device's previous payload
+void BM_DeviceCache(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    const size_t devices = 50000, count = 16384;
+    size_t len = 2 + format.totalLength;
+    CompanyDispatchTable table = buildDispatchTable();
+    DeviceStateCache cache(table, devices);
+    auto initial = makePackets(format, devices, 2);
+    auto fresh = makePackets(format, count, 3);
+    std::vector<const uint8_t*> last(devices);
+    for (size_t d = 0; d < devices; ++d) {
+        last[d] = &initial[d * len];
+        cache.decode(d, last[d], len);
+    }
+    std::mt19937 rng(5);
+    std::vector<uint32_t> addresses(count);
+    std::vector<const uint8_t*> packets(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t d = static_cast<uint32_t>(rng() % devices);
+        bool repeat = static_cast<int64_t>(rng() % 100) < state.range(0);
+        addresses[i] = d;
+        packets[i] = repeat ? last[d] : &fresh[i * len];
+        last[d] = packets[i];
+    }
+    AllocScope allocs;
+    for (auto _ : state) {
+        for (size_t i = 0; i < count; ++i)
+            benchmark::DoNotOptimize(cache.decode(addresses[i], packets[i], len).values);
+    }
+    report(state, allocs.count(), len, count);
+}
+
+// Column reduction; state.range(0) readings, 1 in 16 missing (NaN)
+void BM_SummarizeColumn(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    std::vector<float> column(n);
+    std::mt19937 rng(9);
+    for (size_t i = 0; i < n; ++i)
+        column[i] = (i % 16 == 0) ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>(rng() % 10000) * 0.01f;
+    AllocScope allocs;
+    for (auto _ : state) {
+        ColumnSummary s = summarizeColumn(column.data(), n);
+        benchmark::DoNotOptimize(s);
+    }
+    int64_t readings = state.iterations() * static_cast<int64_t>(n);
+    state.SetItemsProcessed(readings);
+    state.SetBytesProcessed(readings * static_cast<int64_t>(sizeof(float)));
+    state.counters["allocs/iteration"] = state.iterations() ? static_cast<double>(allocs.count()) / state.iterations() : 0.0;
+}
+
+// Catalog of n profiles: the built-in ones repeated under consecutive company IDs
+std::vector<uint8_t> makeCatalog(size_t n) {
+    const std::vector<DeviceProfile>& builtin = getAllProfiles();
+    std::vector<DeviceProfile> profiles;
+    for (size_t i = 0; i < n; ++i) {
+        profiles.push_back(builtin[i % builtin.size()]);
+        profiles.back().manufacturerFormat.companyId = static_cast<uint16_t>(0x2000 + i);
+    }
+    return serializeProfileCatalog(profiles);
+}
+
+void BM_CatalogOpen(benchmark::State& state) {
+    auto bytes = makeCatalog(static_cast<size_t>(state.range(0)));
+    AllocScope allocs;
+    for (auto _ : state) {
+        ProfileCatalogView view;
+        benchmark::DoNotOptimize(view.open(bytes.data(), bytes.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+    state.counters["allocs/iteration"] = state.iterations() ? static_cast<double>(allocs.count()) / state.iterations() : 0.0;
+}
+
+void BM_ParseCatalog(benchmark::State& state, DeviceProfile profile) {
+    const auto& format = profile.manufacturerFormat;
+    auto bytes = serializeProfileCatalog(getAllProfiles());
+    ProfileCatalogView view;
+    view.open(bytes.data(), bytes.size());
+    auto pkt = makePackets(format, 1);
+    std::vector<float> out(format.dataFields.size());
+    AllocScope allocs;
+    for (auto _ : state) {
+        size_t n = view.decode(pkt.data(), pkt.size(), out.data());
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    report(state, allocs.count(), pkt.size(), 1);
+}
+
+void BM_Fingerprint(benchmark::State& state) {
+    const std::vector<DeviceProfile>& profiles = getAllProfiles();
+    FormatFingerprintIndex index(profiles);
+    std::mt19937 rng(11);
+    std::vector<std::vector<uint8_t>> packets(1024);
+    for (auto& p : packets) {
+        p.resize(2 + rng() % 27);
+        for (auto& b : p) b = static_cast<uint8_t>(rng());
+    }
+    const DeviceProfile* candidates[8];
+    AllocScope allocs;
+    for (auto _ : state) {
+        for (const auto& p : packets)
+            benchmark::DoNotOptimize(index.classify(p.data(), p.size(), candidates, 8));
+    }
+    report(state, allocs.count(), 15, packets.size());   // mean advert length
+}
+
+// -------------------------------------------------------------
+// Company ID lookup over a mix of known and unknown IDs
+// -------------------------------------------------------------
+void BM_GetGroupForCompanyId(benchmark::State& state) {
+    std::vector<uint16_t> ids;
+    std::mt19937 rng(7);
+    for (int i = 0; i < 1024; ++i)
+        ids.push_back((i % 3) ? static_cast<uint16_t>(COMPANY_ID_FIRST + rng() % KNOWN_GROUP_COUNT)
+                              : static_cast<uint16_t>(rng()));
+    AllocScope allocs;
+    for (auto _ : state) {
+        for (uint16_t id : ids) benchmark::DoNotOptimize(getGroupForCompanyId(id));
+    }
+    report(state, allocs.count(), 2, ids.size());
+}
+
+// -------------------------------------------------------------
+// Ingest pipeline: a burst of adverts from every built-in profile,
+// pushed round-robin into the producer rings and waited for until the
+// workers have decoded it. Args: producers, workers.
+// -------------------------------------------------------------
+void BM_IngestPipeline(benchmark::State& state) {
+    const size_t producers = static_cast<size_t>(state.range(0));
+    const size_t workers = static_cast<size_t>(state.range(1));
+    constexpr size_t BURST = 8192;
+
+    std::vector<std::vector<uint8_t>> packets;
+    for (const auto& profile : getAllProfiles()) packets.push_back(makePackets(profile.manufacturerFormat, 1));
+
+    CompanyDispatchTable table = buildDispatchTable();
+    IngestPipeline pipeline(table, producers, workers,
+                            [](const DecodedAdvertBatch& batch) { benchmark::DoNotOptimize(batch.count); },
+                            BURST);
+    pipeline.start();
+    for (auto _ : state) {
+        for (size_t i = 0; i < BURST; ++i) {
+            const auto& pkt = packets[i % packets.size()];
+            pipeline.push(i % producers, pkt.data(), pkt.size(), -60, i);
+        }
+        for (IngestStats s = pipeline.stats(); s.decoded + s.unknown < s.accepted; s = pipeline.stats())
+            std::this_thread::yield();
+    }
+    pipeline.stop();
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(BURST));
+    state.counters["dropped"] = static_cast<double>(pipeline.stats().dropped);
+}
+
+template <typename... Defs>
+void registerStaticBenchmarks(ProfileList<Defs...>) {
+    (benchmark::RegisterBenchmark((std::string("ParseStatic/") + Defs::profileName).c_str(), BM_ParseStatic<Defs>), ...);
+}
+
+void registerProfileBenchmarks() {
+    registerStaticBenchmarks(BuiltinProfiles());
+    for (const auto& profile : getAllProfiles()) {
+        const std::string name = profile.profileName;
+        benchmark::RegisterBenchmark(("PackMap/" + name).c_str(), BM_PackMap, profile);
+        benchmark::RegisterBenchmark(("PackInPlace/" + name).c_str(), BM_PackInPlace, profile);
+        benchmark::RegisterBenchmark(("ParseMap/" + name).c_str(), BM_ParseMap, profile);
+        benchmark::RegisterBenchmark(("ParseArena/" + name).c_str(), BM_ParseArena, profile);
+        benchmark::RegisterBenchmark(("ParseCompiled/" + name).c_str(), BM_ParseCompiled, profile);
+        benchmark::RegisterBenchmark(("ParseFixed/" + name).c_str(), BM_ParseFixed, profile);
+        benchmark::RegisterBenchmark(("ParseReadings/" + name).c_str(), BM_ParseReadings, profile);
+        benchmark::RegisterBenchmark(("LookupAndDecode/" + name).c_str(), BM_LookupAndDecode, profile);
+        benchmark::RegisterBenchmark(("ParseCatalog/" + name).c_str(), BM_ParseCatalog, profile);
+        for (auto* bm : {
+                 benchmark::RegisterBenchmark(("BurstParseMap/" + name).c_str(), BM_BurstParseMap, profile),
+                 benchmark::RegisterBenchmark(("BurstCompiled/" + name).c_str(), BM_BurstCompiled, profile),
+                 benchmark::RegisterBenchmark(("BurstBatch/" + name).c_str(), BM_BurstBatch, profile) })
+            bm->Arg(64)->Arg(1024)->Arg(16384);
+        benchmark::RegisterBenchmark(("DeviceCache/" + name).c_str(), BM_DeviceCache, profile)
+            ->Arg(0)->Arg(50)->Arg(90);
+    }
+    benchmark::RegisterBenchmark("GetGroupForCompanyId", BM_GetGroupForCompanyId);
+    benchmark::RegisterBenchmark("SummarizeColumn", BM_SummarizeColumn)->Arg(1024)->Arg(1 << 20);
+    benchmark::RegisterBenchmark("CatalogOpen", BM_CatalogOpen)->Arg(16)->Arg(4096);
+    benchmark::RegisterBenchmark("Fingerprint", BM_Fingerprint);
+    benchmark::RegisterBenchmark("IngestPipeline", BM_IngestPipeline)
+        ->ArgNames({ "producers", "workers" })
+        ->Args({ 1, 1 })->Args({ 1, 4 })->Args({ 2, 8 })->Args({ 4, 4 })
+        ->UseRealTime();
+}
+
+// -------------------------------------------------------------
+// Baseline comparison
+// --save-baseline=FILE stores the fastest CPU time per iteration of every
+// case (over --benchmark_repetitions, which damps noise). --baseline=FILE
+// compares against it; the run exits with status 1 when any case is more
+// than --max-regression percent (default 10) slower. Cases present on only
+// one side are reported but do not fail the run.
+// -------------------------------------------------------------
+using BaselineTimes = std::map<std::string, double>;   // case name -> ns per iteration
+
+class BaselineReporter : public benchmark::ConsoleReporter {
+public:
+    BaselineReporter() : ConsoleReporter(OO_Tabular) {}
+
+    void ReportRuns(const std::vector<Run>& runs) override {
+        ConsoleReporter::ReportRuns(runs);
+        for (const Run& r : runs) {
+            if (r.run_type != Run::RT_Iteration || r.error_occurred) continue;
+            double ns = r.GetAdjustedCPUTime() / benchmark::GetTimeUnitMultiplier(r.time_unit) * 1e9;
+            auto it = fastest.find(r.run_name.str());
+            if (it == fastest.end()) fastest.emplace(r.run_name.str(), ns);
+            else if (ns < it->second) it->second = ns;
+        }
+    }
+
+    BaselineTimes fastest;
+};
+
+bool loadBaseline(const char* path, BaselineTimes& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char name[512];
+    double ns;
+    while (fscanf(f, "%511s %lf", name, &ns) == 2) out[name] = ns;
+    fclose(f);
+    return true;
+}
+
+bool saveBaseline(const char* path, const BaselineTimes& times) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    for (const auto& kv : times) fprintf(f, "%s %.3f\n", kv.first.c_str(), kv.second);
+    return fclose(f) == 0;
+}
+
+// Prints the cases outside +-maxRegression percent; returns the number of regressions
+size_t compareBaseline(const BaselineTimes& baseline, const BaselineTimes& current, double maxRegression) {
+    size_t regressions = 0, improvements = 0, compared = 0;
+    printf("\nBaseline comparison (threshold %.1f%%)\n", maxRegression);
+    for (const auto& kv : current) {
+        auto it = baseline.find(kv.first);
+        if (it == baseline.end()) {
+            printf("  %-56s new case\n", kv.first.c_str());
+            continue;
+        }
+        ++compared;
+        double change = it->second > 0.0 ? (kv.second / it->second - 1.0) * 100.0 : 0.0;
+        if (change > maxRegression) ++regressions;
+        else if (change < -maxRegression) ++improvements;
+        else continue;
+        printf("  %-56s %12.2f ns -> %12.2f ns  %+7.1f%%%s\n", kv.first.c_str(), it->second, kv.second, change,
+               change > maxRegression ? "  REGRESSION" : "");
+    }
+    for (const auto& kv : baseline)
+        if (!current.count(kv.first)) printf("  %-56s not run\n", kv.first.c_str());
+    printf("%zu compared, %zu regressed, %zu improved\n", compared, regressions, improvements);
+    return regressions;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* baselinePath = nullptr;
+    const char* savePath = nullptr;
+    double maxRegression = 10.0;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (!strncmp(argv[i], "--baseline=", 11)) baselinePath = argv[i] + 11;
+        else if (!strncmp(argv[i], "--save-baseline=", 16)) savePath = argv[i] + 16;
+        else if (!strncmp(argv[i], "--max-regression=", 17)) maxRegression = atof(argv[i] + 17);
+        else argv[kept++] = argv[i];
+    }
+    argc = kept;
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    registerProfileBenchmarks();
+
+    if (!baselinePath && !savePath) {
+        benchmark::RunSpecifiedBenchmarks();
+        benchmark::Shutdown();
+        return 0;
+    }
+
+    BaselineTimes baseline;
+    if (baselinePath && !loadBaseline(baselinePath, baseline)) {
+        fprintf(stderr, "%s: cannot read baseline\n", baselinePath);
+        return 2;
+    }
+
+    BaselineReporter reporter;
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+
+    if (savePath && !saveBaseline(savePath, reporter.fastest)) {
+        fprintf(stderr, "%s: cannot write baseline\n", savePath);
+        return 2;
+    }
+    if (baselinePath && compareBaseline(baseline, reporter.fastest, maxRegression) > 0) return 1;
+    return 0;
+}
@@ -0,0 +1,392 @@
+// Differential fuzzer for the decode engines.
+//
+//   clang++ -std=c++17 -O1 -g -fsanitize=fuzzer,address,undefined -I.. ble_decode_fuzz.cpp -o ble_decode_fuzz
+//   ./ble_decode_fuzz corpus/
+//
+// Without libFuzzer (any compiler), a driver runs the given inputs, or
+// random ones when none are given:
+//
+//   g++ -std=c++17 -O1 -g -fsanitize=address,undefined -DBLE_FUZZ_STANDALONE -I.. ble_decode_fuzz.cpp -o ble_decode_fuzz
+//   ./ble_decode_fuzz [-runs n] [-seed n] [input...]
+//
+// Each input describes a random ManufacturerDataFormat and a few payloads
+// (short, long and truncated ones). Bit fields get any bitOffset and
+// bitWidth, including ones validateFormat() rejects. Some formats are edited after validateFormat()
+// accepted them. Every payload is decoded by the scalar
+// parseManufacturerData overloads, CompiledFormat, strided and scattered
+// decodeBatch, decodeSegments over a random split, a serialized
+// ProfileCatalogView (when the catalog accepts the format) and
+// FixedPointFormat.
+// The same bytes also go through every built-in StaticProfile. Results
+// must be bit-identical, except that all NaNs compare equal, and no
+// engine may read outside the payload. For formats that pass
+// validateFormat() the encoders must produce identical bytes.
+// Any difference prints the case and aborts.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../BLEDeviceProfiles.h"
+#include "../BLECompiledFormat.h"
+#include "../BLEStaticProfile.h"
+#include "../BLEBatchDecode.h"
+#include "../BLEFragmentAssembly.h"
+#include "../BLEProfileCatalog.h"
+#include "../BLEFixedPoint.h"
+#include "../BLEProfileValidation.h"
+
+using namespace BLEProfiles;
+
+namespace {
+
+constexpr size_t MAX_FIELDS = 16;
+constexpr size_t MAX_PAYLOADS = 8;
+constexpr size_t MAX_TOTAL_LENGTH = 300;
+
+// Consumes the fuzz input; reads past the end return 0
+class InputReader {
+public:
+    InputReader(const uint8_t* data, size_t size) : data_(data), size_(size), pos_(0) {}
+
+    uint8_t byte() { return pos_ < size_ ? data_[pos_++] : 0; }
+    uint16_t u16() { uint16_t lo = byte(); return static_cast<uint16_t>(lo | (byte() << 8)); }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+bool sameValue(float a, float b) {
+    return (a != a && b != b) || memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+[[noreturn]] void fail(const ManufacturerDataFormat& format, const uint8_t* pkt, size_t len,
+                       const char* engine, size_t field, float expected, float actual) {
+    fprintf(stderr, "mismatch in %s, field %zu: expected %a, got %a\n", engine, field, expected, actual);
+    fprintf(stderr, "format: totalLength %u\n", static_cast<unsigned>(format.totalLength));
+    for (const auto& f : format.dataFields)
+        fprintf(stderr, "  %s offset %u type %d bits %u/%u scale %a\n", f.sensorName.c_str(),
+                static_cast<unsigned>(f.offset), static_cast<int>(f.dataType),
+                static_cast<unsigned>(f.bitOffset), static_cast<unsigned>(f.bitWidth), f.scale);
+    fprintf(stderr, "payload (%zu bytes):", len);
+    for (size_t i = 0; i < len; ++i) fprintf(stderr, " %02X", pkt[i]);
+    fprintf(stderr, "\n");
+    abort();
+}
+
+void check(bool ok, const ManufacturerDataFormat& format, const uint8_t* pkt, size_t len, const char* engine) {
+    if (!ok) fail(format, pkt, len, engine, 0, 0.0f, 0.0f);
+}
+
+// Mostly sane bit layouts, otherwise any two bytes
+void setBitLayout(DataFieldConfig& f, InputReader& in) {
+    uint8_t layout = in.byte();
+    uint8_t bitOffset = static_cast<uint8_t>(layout & 7);
+    uint8_t bitWidth = static_cast<uint8_t>(1 + (layout >> 3) % 32);
+    if (layout & 0x80) {
+        bitOffset = in.byte();
+        bitWidth = in.byte();
+    }
+    f.bitOffset = bitOffset;
+    f.bitWidth = bitWidth;
+}
+
+void addField(ManufacturerDataFormat& format, InputReader& in) {
+    static const float scales[] = { 0.0f, 1.0f, 0.1f, 0.01f, 0.5f, -2.0f, 0.001f, 3.7f, 1e6f, 0.25f };
+    DataType type = static_cast<DataType>(in.byte() % (static_cast<uint8_t>(DataType::INT_BITS) + 1));
+    uint16_t offset = static_cast<uint16_t>(in.u16() % (format.totalLength + 6u));
+    float scale = scales[in.byte() % (sizeof(scales) / sizeof(scales[0]))];
+    format.dataFields.emplace_back("Fuzz" + std::to_string(format.dataFields.size()), offset, type, scale);
+    if (isBitFieldType(type)) setBitLayout(format.dataFields.back(), in);
+}
+
+ManufacturerDataFormat readFormat(InputReader& in) {
+    ManufacturerDataFormat format(static_cast<uint16_t>(0x2000 | (in.byte() & 0x0F)), "fuzz");
+    uint8_t shape = in.byte();
+    format.totalLength = static_cast<uint16_t>((shape & 0x80) ? in.u16() % (MAX_TOTAL_LENGTH + 1) : shape % 40);
+
+    size_t fieldCount = in.byte() % (MAX_FIELDS + 1);
+    for (size_t i = 0; i < fieldCount; ++i) addField(format, in);
+    return format;
+}
+
+// Edits application code might make after validateFormat(): move, retype
+// or relayout a field, add one, or shrink totalLength
+void editFormat(ManufacturerDataFormat& format, InputReader& in) {
+    size_t edits = 1 + in.byte() % 4;
+    for (size_t e = 0; e < edits; ++e) {
+        uint8_t op = in.byte();
+        if (format.dataFields.empty() || op % 5 == 3) {
+            if (format.dataFields.size() < MAX_FIELDS) addField(format, in);
+            continue;
+        }
+        DataFieldConfig& f = format.dataFields[in.byte() % format.dataFields.size()];
+        switch (op % 5) {
+            case 0: f.offset = static_cast<uint16_t>(f.offset + 1 + in.byte() % 8); break;
+            case 1: f.dataType = static_cast<DataType>(in.byte() % (static_cast<uint8_t>(DataType::INT_BITS) + 1)); break;
+            case 2: f.dataType = DataType::UINT_BITS; setBitLayout(f, in); break;
+            default: format.totalLength = static_cast<uint16_t>(format.totalLength / 2); break;
+        }
+    }
+}
+
+bool fits(const DataFieldConfig& f, size_t len) {
+    return len >= 2 && static_cast<size_t>(f.offset) + fieldByteSize(f) <= len - 2;
+}
+
+// Scalar, segmented, catalog and fixed-point engines against CompiledFormat::decode()
+void checkPacket(const ManufacturerDataFormat& format, const CompiledFormat& compiled,
+                 const ProfileCatalogView* catalog, const FixedPointFormat& fixed,
+                 const uint8_t* pkt, size_t len, InputReader& in) {
+    const size_t n = compiled.fieldCount();
+    float ref[MAX_FIELDS];
+    size_t refDecoded = compiled.decode(pkt, len, ref);
+    size_t fitting = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (fits(format.dataFields[i], len)) ++fitting;
+        else if (ref[i] == ref[i]) fail(format, pkt, len, "CompiledFormat (missing field)", i, NAN, ref[i]);
+    }
+    check(refDecoded == fitting, format, pkt, len, "CompiledFormat (count)");
+
+    std::map<std::string, float> values = parseManufacturerData(pkt, len, format);
+    check(values.size() == fitting, format, pkt, len, "parseManufacturerData map (count)");
+    for (size_t i = 0; i < n; ++i) {
+        auto it = values.find(format.dataFields[i].sensorName);
+        if (it == values.end()) continue;
+        if (!sameValue(ref[i], it->second)) fail(format, pkt, len, "parseManufacturerData map", i, ref[i], it->second);
+    }
+
+    SensorReading readings[MAX_FIELDS];
+    size_t count = parseManufacturerData(pkt, len, format, readings, MAX_FIELDS);
+    check(count == fitting, format, pkt, len, "parseManufacturerData readings (count)");
+    for (size_t i = 0, r = 0; i < n; ++i) {
+        if (!fits(format.dataFields[i], len)) continue;
+        check(readings[r].id == format.dataFields[i].nameId, format, pkt, len, "parseManufacturerData readings (id)");
+        if (!sameValue(ref[i], readings[r].value))
+            fail(format, pkt, len, "parseManufacturerData readings", i, ref[i], readings[r].value);
+        ++r;
+    }
+
+    // Random split into up to 8 segments, zero-length ones included
+    BufferSegment segments[8];
+    size_t segmentCount = 0, pos = 0;
+    while (pos < len && segmentCount < 7) {
+        size_t take = in.byte() % 8;
+        if (take > len - pos) take = len - pos;
+        segments[segmentCount++] = { pkt + pos, take };
+        pos += take;
+    }
+    segments[segmentCount++] = { pkt + pos, len - pos };
+    float seg[MAX_FIELDS];
+    size_t segDecoded = decodeSegments(compiled, SegmentedBuffer(segments, segmentCount), seg);
+    check(segDecoded == (len >= 2 ? refDecoded : 0), format, pkt, len, "decodeSegments (count)");
+    for (size_t i = 0; i < n; ++i)
+        if (!sameValue(ref[i], seg[i])) fail(format, pkt, len, "decodeSegments", i, ref[i], seg[i]);
+
+    if (catalog && len >= 2) {
+        float cat[MAX_FIELDS];
+        size_t catDecoded = catalog->decode(pkt, len, cat);
+        check(catDecoded == refDecoded, format, pkt, len, "ProfileCatalogView (count)");
+        for (size_t i = 0; i < n; ++i)
+            if (!sameValue(ref[i], cat[i])) fail(format, pkt, len, "ProfileCatalogView", i, ref[i], cat[i]);
+    }
+
+    int64_t raw[MAX_FIELDS];
+    size_t fixedDecoded = fixed.decode(pkt, len, raw);
+    check(fixedDecoded == refDecoded, format, pkt, len, "FixedPointFormat (count)");
+    for (size_t i = 0; i < n; ++i)
+        check((raw[i] == FIXED_MISSING) == !fits(format.dataFields[i], len), format, pkt, len, "FixedPointFormat (missing)");
+}
+
+// Both decodeBatch overloads against per-packet CompiledFormat::decode()
+void checkBatch(const ManufacturerDataFormat& format, const CompiledFormat& compiled,
+                const uint8_t* const* packets, const size_t* lengths, size_t count) {
+    const size_t n = compiled.fieldCount();
+    std::vector<float> storage(2 * n * MAX_PAYLOADS);
+    float* scattered[MAX_FIELDS];
+    float* strided[MAX_FIELDS];
+    for (size_t i = 0; i < n; ++i) {
+        scattered[i] = &storage[i * MAX_PAYLOADS];
+        strided[i] = &storage[(n + i) * MAX_PAYLOADS];
+    }
+
+    size_t complete = decodeBatch(compiled, packets, lengths, count, scattered);
+    size_t expectComplete = 0;
+    size_t stride = 0;
+    for (size_t r = 0; r < count; ++r) {
+        float ref[MAX_FIELDS];
+        if (compiled.decode(packets[r], lengths[r], ref) == n) ++expectComplete;
+        for (size_t i = 0; i < n; ++i)
+            if (!sameValue(ref[i], scattered[i][r]))
+                fail(format, packets[r], lengths[r], "decodeBatch scattered", i, ref[i], scattered[i][r]);
+        if (lengths[r] > stride) stride = lengths[r];
+    }
+    if (n) check(complete == expectComplete, format, packets[0], lengths[0], "decodeBatch scattered (count)");
+
+    // Strided: every row padded to the longest packet, as a capture ring would hold them
+    if (count == 0 || stride < 2 + compiled.minPayloadLength) return;
+    std::vector<uint8_t> rows(stride * count, 0);
+    for (size_t r = 0; r < count; ++r) memcpy(&rows[r * stride], packets[r], lengths[r]);
+    check(decodeBatch(compiled, rows.data(), stride, count, strided) == count, format, rows.data(), stride,
+          "decodeBatch strided (count)");
+    for (size_t r = 0; r < count; ++r) {
+        float ref[MAX_FIELDS];
+        compiled.decode(&rows[r * stride], stride, ref);
+        for (size_t i = 0; i < n; ++i)
+            if (!sameValue(ref[i], strided[i][r]))
+                fail(format, &rows[r * stride], stride, "decodeBatch strided", i, ref[i], strided[i][r]);
+    }
+}
+
+// Valid formats: the in-place and map packers against CompiledFormat::encode()
+void checkEncoders(const ManufacturerDataFormat& format, const CompiledFormat& compiled, const float* values) {
+    const size_t len = 2 + static_cast<size_t>(format.totalLength);
+    std::vector<uint8_t> expect(len), actual(len);
+    check(compiled.encode(values, expect.data(), len) == len, format, nullptr, 0, "CompiledFormat::encode");
+
+    check(packManufacturerData(values, compiled.fieldCount(), format, actual.data(), len) == len,
+          format, expect.data(), len, "packManufacturerData in place (length)");
+    check(actual == expect, format, actual.data(), len, "packManufacturerData in place");
+
+    std::map<std::string, float> map;
+    for (size_t i = 0; i < compiled.fieldCount(); ++i)
+        if (values[i] == values[i]) map[format.dataFields[i].sensorName] = values[i];
+    std::vector<uint8_t> packed = packManufacturerData(map, format);
+    check(packed == expect, format, packed.data(), packed.size(), "packManufacturerData map");
+}
+
+// StaticProfile<Def> against the CompiledFormat of the same definition
+template <typename Def>
+void checkStatic(InputReader& in) {
+    using Profile = StaticProfile<Def>;
+    static const DeviceProfile profile = Profile::toDeviceProfile();
+    static const CompiledFormat compiled(profile.manufacturerFormat);
+
+    uint8_t pkt[Profile::packedLength];
+    for (auto& b : pkt) b = in.byte();
+    pkt[0] = static_cast<uint8_t>(Profile::companyId & 0xFF);
+    pkt[1] = static_cast<uint8_t>(Profile::companyId >> 8);
+    size_t len = in.byte() % (Profile::packedLength + 1);
+
+    typename Profile::Values values;
+    float ref[Profile::fieldCount];
+    bool parsed = Profile::parse(pkt, len, values);
+    bool complete = compiled.decode(pkt, len, ref) == Profile::fieldCount;
+    check(parsed == (complete && len >= 2 + Profile::minPayloadLength), profile.manufacturerFormat, pkt, len,
+          "StaticProfile::parse (result)");
+    if (!parsed) return;
+    for (size_t i = 0; i < Profile::fieldCount; ++i)
+        if (!sameValue(ref[i], values[i])) fail(profile.manufacturerFormat, pkt, len, "StaticProfile::parse", i, ref[i], values[i]);
+
+    // Missing values (NaN) must leave their field zero in both encoders
+    uint8_t missing = in.byte();
+    for (size_t i = 0; i < Profile::fieldCount; ++i)
+        if (missing & (1u << (i % 8))) values[i] = std::numeric_limits<float>::quiet_NaN();
+
+    uint8_t expect[Profile::packedLength], actual[Profile::packedLength];
+    compiled.encode(values.data(), expect, sizeof(expect));
+    Profile::pack(values, actual, sizeof(actual));
+    check(!memcmp(expect, actual, sizeof(expect)), profile.manufacturerFormat, actual, sizeof(actual), "StaticProfile::pack");
+}
+
+template <typename... Defs>
+void checkStaticProfiles(ProfileList<Defs...>, InputReader& in) {
+    (checkStatic<Defs>(in), ...);
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    InputReader in(data, size);
+    DeviceProfile profile;
+    profile.profileName = "Fuzz";
+    profile.deviceName = "Fuzz";
+    profile.manufacturerFormat = readFormat(in);
+    const ManufacturerDataFormat& format = profile.manufacturerFormat;
+
+    if (validateFormat(format).ok() && (in.byte() & 1)) editFormat(profile.manufacturerFormat, in);
+    const bool valid = validateFormat(format).ok();
+    const CompiledFormat compiled(format);
+    const FixedPointFormat fixed(format);
+
+    std::vector<uint8_t> catalogBytes = serializeProfileCatalog({ profile });
+    ProfileCatalogView catalog;
+    const bool haveCatalog = catalog.open(catalogBytes.data(), catalogBytes.size());
+
+    const size_t payloadCount = 1 + in.byte() % MAX_PAYLOADS;
+    std::vector<std::vector<uint8_t>> payloads(payloadCount);
+    const uint8_t* packets[MAX_PAYLOADS];
+    size_t lengths[MAX_PAYLOADS];
+    for (size_t p = 0; p < payloadCount; ++p) {
+        uint8_t mode = in.byte();
+        size_t len = (mode & 0xC0) ? 2 + format.totalLength : mode % (format.totalLength + 9u);
+        auto& pkt = payloads[p];
+        pkt.resize(len ? len : 1);   // keep a valid pointer for empty payloads
+        for (auto& b : pkt) b = in.byte();
+        if (len >= 2) {
+            pkt[0] = static_cast<uint8_t>(format.companyId & 0xFF);
+            pkt[1] = static_cast<uint8_t>(format.companyId >> 8);
+        }
+        packets[p] = pkt.data();
+        lengths[p] = len;
+        checkPacket(format, compiled, haveCatalog ? &catalog : nullptr, fixed, pkt.data(), len, in);
+    }
+    checkBatch(format, compiled, packets, lengths, payloadCount);
+
+    if (valid) {
+        float values[MAX_FIELDS];
+        for (size_t p = 0; p < payloadCount; ++p) {
+            compiled.decode(packets[p], lengths[p], values);
+            checkEncoders(format, compiled, values);
+        }
+    }
+
+    checkStaticProfiles(BuiltinProfiles(), in);
+    return 0;
+}
+
+#if defined(BLE_FUZZ_STANDALONE)
+int main(int argc, char** argv) {
+    unsigned long runs = 100000;
+    unsigned long seed = 1;
+    std::vector<const char*> inputs;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-runs") && i + 1 < argc) runs = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "-seed") && i + 1 < argc) seed = strtoul(argv[++i], nullptr, 10);
+        else inputs.push_back(argv[i]);
+    }
+
+    for (const char* path : inputs) {
+        FILE* f = fopen(path, "rb");
+        if (!f) {
+            fprintf(stderr, "%s: cannot open\n", path);
+            return 1;
+        }
+        std::vector<uint8_t> bytes;
+        uint8_t buf[4096];
+        for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0;) bytes.insert(bytes.end(), buf, buf + n);
+        fclose(f);
+        LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+    }
+    if (!inputs.empty()) return 0;
+
+    std::mt19937 rng(static_cast<uint32_t>(seed));
+    std::vector<uint8_t> bytes;
+    for (unsigned long r = 0; r < runs; ++r) {
+        bytes.resize(rng() % 512);
+        for (auto& b : bytes) b = static_cast<uint8_t>(rng());
+        LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+    }
+    printf("%lu random inputs, no mismatches\n", runs);
+    return 0;
+}
+#endif